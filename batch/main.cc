@@ -0,0 +1,458 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <poly2tri/poly2tri.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+using namespace p2t;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  /// Directory for the mesh files, nothing is written if empty
+  std::string output;
+  size_t slowest = 5;
+  std::vector<std::string> inputs;
+};
+
+/// One polygon to triangulate: a .dat file the worker reads itself, or a polygon decoded from a
+/// WKB or WKT stream
+struct Job {
+  std::string name;
+  std::string dat_path;
+  std::vector<Point> points;
+  std::vector<size_t> ring_sizes;
+};
+
+struct Result {
+  std::string name;
+  double milliseconds = 0;
+  size_t points = 0;
+  size_t triangles = 0;
+  /// what() of the exception if triangulating failed
+  std::string error;
+};
+
+/// Hands the jobs from the reading thread to the workers. It is bounded, so that a long stream
+/// isn't read into memory faster than it can be triangulated.
+class JobQueue {
+public:
+  explicit JobQueue(size_t capacity) : capacity_(capacity)
+  {
+  }
+
+  void Push(Job job)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return jobs_.size() < capacity_; });
+    jobs_.push_back(std::move(job));
+    not_empty_.notify_one();
+  }
+
+  /// Returns false once the queue has been closed and is empty
+  bool Pop(Job& job)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !jobs_.empty() || closed_; });
+    if (jobs_.empty()) {
+      return false;
+    }
+    job = std::move(jobs_.front());
+    jobs_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void Close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+private:
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<Job> jobs_;
+  const size_t capacity_;
+  bool closed_ = false;
+};
+
+/// Turns every polygon of a stream into a job
+class JobMaker : public PolygonVisitor {
+public:
+  JobMaker(std::string name, JobQueue& queue) : name_(std::move(name)), queue_(queue)
+  {
+  }
+
+  void Visit(const std::vector<Point*>& outline,
+             const std::vector<std::vector<Point*>>& holes) override
+  {
+    Job job;
+    job.name = name_ + "#" + std::to_string(count_++);
+    job.ring_sizes.push_back(outline.size());
+    for (const Point* point : outline) {
+      job.points.emplace_back(point->x, point->y);
+    }
+    for (const std::vector<Point*>& hole : holes) {
+      job.ring_sizes.push_back(hole.size());
+      for (const Point* point : hole) {
+        job.points.emplace_back(point->x, point->y);
+      }
+    }
+    queue_.Push(std::move(job));
+  }
+
+private:
+
+  const std::string name_;
+  JobQueue& queue_;
+  size_t count_ = 0;
+};
+
+bool EndsWith(const std::string& text, const std::string& suffix)
+{
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string BaseName(const std::string& path)
+{
+  const size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool IsPolygonFile(const std::string& path)
+{
+  return EndsWith(path, ".dat") || EndsWith(path, ".wkb") || EndsWith(path, ".wkt");
+}
+
+/// Polygon files in a directory, sorted. Returns false if the path isn't a directory.
+bool ListDirectory(const std::string& path, std::vector<std::string>& out)
+{
+  std::vector<std::string> names;
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  HANDLE find = FindFirstFileA((path + "\\*").c_str(), &data);
+  if (find == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      names.emplace_back(data.cFileName);
+    }
+  } while (FindNextFileA(find, &data));
+  FindClose(find);
+#else
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    return false;
+  }
+  while (const dirent* entry = readdir(dir)) {
+    names.emplace_back(entry->d_name);
+  }
+  closedir(dir);
+#endif
+  std::sort(names.begin(), names.end());
+  for (const std::string& name : names) {
+    if (IsPolygonFile(name)) {
+      out.push_back(path + "/" + name);
+    }
+  }
+  return true;
+}
+
+Result Triangulate(const Job& job, const Options& options)
+{
+  Result result;
+  result.name = job.name;
+  const auto start = Clock::now();
+  try {
+    std::unique_ptr<DatFile> file;
+    std::vector<Point> points;
+    std::vector<Point*> polyline;
+    std::vector<std::vector<Point*>> holes;
+    std::vector<Point*> steiner;
+    if (!job.dat_path.empty()) {
+      file.reset(new DatFile(job.dat_path));
+      polyline = file->polyline();
+      holes = file->holes();
+      steiner = file->steiner();
+      result.points = file->points().size();
+    } else {
+      points = job.points;
+      size_t start = 0;
+      for (size_t ring = 0; ring < job.ring_sizes.size(); ring++) {
+        if (ring > 0) {
+          holes.emplace_back();
+        }
+        std::vector<Point*>& list = ring == 0 ? polyline : holes.back();
+        for (size_t i = start; i < start + job.ring_sizes[ring]; i++) {
+          list.push_back(&points[i]);
+        }
+        start += job.ring_sizes[ring];
+      }
+      result.points = points.size();
+    }
+
+    CDT cdt(polyline);
+    for (const std::vector<Point*>& hole : holes) {
+      cdt.AddHole(hole);
+    }
+    for (Point* point : steiner) {
+      cdt.AddPoint(point);
+    }
+    cdt.Triangulate();
+    result.triangles = cdt.GetTriangles().size();
+
+    if (!options.output.empty()) {
+      std::string name = BaseName(job.name);
+      std::replace(name.begin(), name.end(), '#', '.');
+      const std::string path = options.output + "/" + name + ".p2tm";
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      WriteMesh(out, cdt);
+      if (!out.flush()) {
+        throw std::runtime_error("can't write " + path);
+      }
+    }
+  } catch (const std::exception& e) {
+    result.error = e.what();
+  }
+  result.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  return result;
+}
+
+/// Queue the polygons of one input. Errors reading a stream are reported as a failed input.
+/// The mesh files are named after the input file, outputs holds the inputs each name was taken
+/// by. Inputs with the same name in different directories would overwrite each other's meshes.
+void ReadInput(const std::string& path, const Options& options,
+               std::map<std::string, std::string>& outputs, JobQueue& queue,
+               std::vector<Result>& read_errors)
+{
+  try {
+    if (!options.output.empty()) {
+      if (!outputs.emplace(path == "-" ? "stdin" : BaseName(path), path).second) {
+        throw std::runtime_error("mesh file names already taken by another input");
+      }
+    }
+    if (path != "-" && EndsWith(path, ".dat")) {
+      Job job;
+      job.name = path;
+      job.dat_path = path;
+      queue.Push(std::move(job));
+      return;
+    }
+    JobMaker maker(path == "-" ? "stdin" : path, queue);
+    std::ifstream file;
+    if (path != "-") {
+      file.open(path, std::ios::binary);
+      if (!file) {
+        throw std::runtime_error("can't open " + path);
+      }
+    }
+    std::istream& in = path == "-" ? std::cin : file;
+    // WKB starts with the byte order, 0 or 1
+    const int first = in.peek();
+    if (first == 0 || first == 1 || EndsWith(path, ".wkb")) {
+      ReadWkb(in, maker);
+    } else {
+      ReadWkt(in, maker);
+    }
+  } catch (const std::exception& e) {
+    Result result;
+    result.name = path == "-" ? "stdin" : path;
+    result.error = e.what();
+    read_errors.push_back(result);
+  }
+}
+
+void PrintUsage()
+{
+  std::fprintf(stderr,
+               "Usage: p2t-batch [-j threads] [-o directory] [-s count] input...\n"
+               "\n"
+               "Triangulates polygons from .dat files, WKB (.wkb) or WKT (.wkt) streams, or\n"
+               "directories containing them. - reads WKB or WKT from stdin.\n"
+               "\n"
+               "  -j threads    number of worker threads, default: number of cores\n"
+               "  -o directory  write a binary mesh file for every polygon, named after the\n"
+               "                input file; inputs with the same name fail\n"
+               "  -s count      number of slowest inputs to report, default: 5\n");
+}
+
+bool ParseArguments(int argc, char* argv[], Options& options)
+{
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if ((arg == "-j" || arg == "-o" || arg == "-s") && i + 1 < argc) {
+      const std::string value = argv[++i];
+      if (arg == "-o") {
+        options.output = value;
+      } else {
+        char* end;
+        const unsigned long number = std::strtoul(value.c_str(), &end, 10);
+        if (*end != '\0' || value.empty() || (arg == "-j" && number == 0)) {
+          return false;
+        }
+        (arg == "-j" ? options.threads : options.slowest) = number;
+      }
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      return false;
+    } else {
+      options.inputs.push_back(arg);
+    }
+  }
+  return !options.inputs.empty();
+}
+
+void Report(const Options& options, std::vector<Result>& results, double seconds)
+{
+  size_t points = 0, triangles = 0, failed = 0;
+  std::map<std::string, std::pair<size_t, std::string>> failures; // count and first input
+  for (const Result& result : results) {
+    points += result.points;
+    triangles += result.triangles;
+    if (!result.error.empty()) {
+      ++failed;
+      auto& failure = failures[result.error];
+      if (failure.first++ == 0) {
+        failure.second = result.name;
+      }
+    }
+  }
+  std::printf("%zu inputs in %.3f s with %zu threads: %.0f inputs/s, %.0f points/s\n",
+              results.size(), seconds, options.threads, results.size() / seconds,
+              points / seconds);
+  std::printf("%zu triangulated (%zu triangles), %zu failed\n", results.size() - failed,
+              triangles, failed);
+  if (!failures.empty()) {
+    std::printf("\nfailures:\n");
+    for (const auto& failure : failures) {
+      std::printf("%8zu  %s (first: %s)\n", failure.second.first, failure.first.c_str(),
+                  failure.second.second.c_str());
+    }
+  }
+  const size_t slowest = std::min(options.slowest, results.size());
+  if (slowest > 0) {
+    std::partial_sort(results.begin(), results.begin() + slowest, results.end(),
+                      [](const Result& a, const Result& b) {
+                        return a.milliseconds > b.milliseconds;
+                      });
+    std::printf("\nslowest:\n");
+    for (size_t i = 0; i < slowest; i++) {
+      std::printf("%8.2f ms %10zu points  %s\n", results[i].milliseconds, results[i].points,
+                  results[i].name.c_str());
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!ParseArguments(argc, argv, options)) {
+    PrintUsage();
+    return 2;
+  }
+#ifdef _WIN32
+  _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+  const auto start = Clock::now();
+  JobQueue queue(4 * options.threads);
+  std::vector<std::vector<Result>> results(options.threads);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < options.threads; i++) {
+    workers.emplace_back([&queue, &options, &results, i] {
+      Job job;
+      while (queue.Pop(job)) {
+        results[i].push_back(Triangulate(job, options));
+      }
+    });
+  }
+
+  std::vector<Result> all;
+  std::map<std::string, std::string> outputs;
+  for (const std::string& input : options.inputs) {
+    std::vector<std::string> files;
+    if (input != "-" && ListDirectory(input, files)) {
+      for (const std::string& file : files) {
+        ReadInput(file, options, outputs, queue, all);
+      }
+    } else {
+      ReadInput(input, options, outputs, queue, all);
+    }
+  }
+  queue.Close();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  for (std::vector<Result>& list : results) {
+    all.insert(all.end(), list.begin(), list.end());
+  }
+  const bool failed =
+    std::any_of(all.begin(), all.end(), [](const Result& result) { return !result.error.empty(); });
+  Report(options, all, seconds);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,883 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <poly2tri/poly2tri.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace p2t;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const double pi = 3.14159265358979323846;
+
+/// Run the function repeatedly for at least 200 ms, returns microseconds per call
+double Measure(const std::function<void()>& fun)
+{
+  size_t runs = 0;
+  const auto start = Clock::now();
+  auto elapsed = Clock::duration::zero();
+  do {
+    fun();
+    ++runs;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+  return std::chrono::duration<double, std::micro>(elapsed).count() / runs;
+}
+
+/// Triangulate once, the points are reused so their edge lists have to be reset
+void Triangulate(const std::vector<Point*>& polyline, bool fast_path)
+{
+  {
+    CDT cdt(polyline);
+    cdt.SetMonotoneFastPath(fast_path);
+    cdt.Triangulate();
+  }
+  for (Point* point : polyline) {
+    point->edge_list.clear();
+  }
+}
+
+std::vector<Point*> Ellipse(size_t num_points)
+{
+  std::vector<Point*> polyline;
+  for (size_t i = 0; i < num_points; i++) {
+    const double angle = 2 * pi * (i + 0.3 * std::sin(i)) / num_points;
+    polyline.push_back(new Point(3 * std::cos(angle), 2 * std::sin(angle)));
+  }
+  return polyline;
+}
+
+std::vector<Point*> RoundedBox(size_t points_per_corner)
+{
+  std::vector<Point*> polyline;
+  const double centers[4][2] = { { 10, 5 }, { -10, 5 }, { -10, -5 }, { 10, -5 } };
+  for (size_t corner = 0; corner < 4; corner++) {
+    for (size_t i = 0; i < points_per_corner; i++) {
+      const double angle = pi / 2 * (corner + double(i) / (points_per_corner - 1));
+      polyline.push_back(new Point(centers[corner][0] + std::cos(angle),
+                                   centers[corner][1] + std::sin(angle)));
+    }
+  }
+  return polyline;
+}
+
+std::vector<Point*> Monotone(size_t num_points)
+{
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> random(0, 1);
+  const size_t half = num_points / 2;
+  std::vector<Point*> polyline{ new Point(0, 0) };
+  for (size_t i = 1; i < half; i++) {
+    polyline.push_back(new Point(1 + random(generator), i + 0.5 * random(generator)));
+  }
+  polyline.push_back(new Point(0, half));
+  for (size_t i = half - 1; i > 0; i--) {
+    polyline.push_back(new Point(-1 - random(generator), i + 0.5 * random(generator)));
+  }
+  return polyline;
+}
+
+/// Star with alternating radii, slightly irregular to avoid cocircular points
+std::vector<Point*> Star(size_t num_points)
+{
+  std::vector<Point*> polyline;
+  for (size_t i = 0; i < num_points; i++) {
+    const double angle = 2 * pi * (i + 0.1 * std::sin(i)) / num_points;
+    const double radius = i % 2 == 0 ? 1 : 0.4 + 0.01 * i;
+    polyline.push_back(new Point(radius * std::cos(angle), radius * std::sin(angle)));
+  }
+  return polyline;
+}
+
+void BenchmarkMonotone()
+{
+  struct Shape {
+    std::string name;
+    std::vector<Point*> polyline;
+  };
+  std::vector<Shape> shapes{
+    { "rectangle", { new Point(0, 0), new Point(2, 0), new Point(2, 1), new Point(0, 1) } },
+    { "rounded box", RoundedBox(8) },
+    { "ellipse", Ellipse(1000) },
+    { "monotone", Monotone(1000) },
+  };
+  std::printf("%-12s %8s %12s %12s %8s\n", "monotone", "points", "sweep (us)", "fast (us)",
+              "speedup");
+  for (auto& shape : shapes) {
+    const double sweep = Measure([&] { Triangulate(shape.polyline, false); });
+    const double fast = Measure([&] { Triangulate(shape.polyline, true); });
+    std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", shape.name.c_str(), shape.polyline.size(),
+                sweep, fast, sweep / fast);
+    for (Point* point : shape.polyline) {
+      delete point;
+    }
+  }
+}
+
+void BenchmarkSmall()
+{
+  struct Shape {
+    std::string name;
+    std::vector<Point*> polyline;
+  };
+  std::vector<Shape> shapes{
+    { "quad", { new Point(0, 0), new Point(0, 1), new Point(1, 1), new Point(1, 0) } },
+    { "star", Star(12) },
+    { "rounded box", RoundedBox(4) },
+  };
+  std::printf("%-12s %8s %12s %12s %8s\n", "small", "points", "cdt (ns)", "small (ns)",
+              "speedup");
+  for (auto& shape : shapes) {
+    const double cdt = 1000 * Measure([&] { Triangulate(shape.polyline, true); });
+    SmallTriangulation result;
+    const double small = 1000 * Measure([&] {
+      TriangulateSmallPolygon(shape.polyline.data(), shape.polyline.size(), result);
+    });
+    std::printf("%-12s %8zu %12.0f %12.0f %7.1fx\n", shape.name.c_str(), shape.polyline.size(),
+                cdt, small, cdt / small);
+    for (Point* point : shape.polyline) {
+      delete point;
+    }
+  }
+}
+
+void BenchmarkIncremental()
+{
+  // A refinement wave of Steiner points and then breaklines added to an already refined ellipse
+  const size_t num_points = 20000, wave = 2000;
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<double> random(0, 1);
+  const std::vector<Point*> polyline = Ellipse(200);
+  std::vector<Point*> steiner;
+  for (size_t i = 0; i < num_points + wave; i++) {
+    const double angle = 2 * pi * random(generator);
+    const double radius = 0.95 * std::sqrt(random(generator));
+    steiner.push_back(new Point(3 * radius * std::cos(angle), 2 * radius * std::sin(angle)));
+  }
+
+  const auto sweep_start = Clock::now();
+  {
+    CDT cdt(polyline);
+    for (Point* point : steiner) {
+      cdt.AddPoint(point);
+    }
+    cdt.Triangulate();
+  }
+  const double sweep =
+    std::chrono::duration<double, std::milli>(Clock::now() - sweep_start).count();
+  for (Point* point : polyline) {
+    point->edge_list.clear();
+  }
+
+  CDT cdt(polyline);
+  for (size_t i = 0; i < num_points; i++) {
+    cdt.AddPoint(steiner[i]);
+  }
+  cdt.Triangulate();
+  const auto insert_start = Clock::now();
+  for (size_t i = num_points; i < steiner.size(); i++) {
+    cdt.InsertPoint(steiner[i]);
+  }
+  const double insert =
+    std::chrono::duration<double, std::milli>(Clock::now() - insert_start).count();
+
+  // Short parallel segments, so they don't cross each other
+  const size_t num_breaklines = 100;
+  std::vector<Point*> endpoints;
+  for (size_t i = 0; i < num_breaklines; i++) {
+    const double y = -1.5 + 3.0 * i / num_breaklines;
+    endpoints.push_back(new Point(-0.5 + 0.5 * random(generator), y));
+    endpoints.push_back(new Point(0.5 * random(generator), y));
+  }
+  const auto breaklines_start = Clock::now();
+  for (size_t i = 0; i < endpoints.size(); i += 2) {
+    cdt.InsertConstraint(endpoints[i], endpoints[i + 1]);
+  }
+  const double breaklines =
+    std::chrono::duration<double, std::milli>(Clock::now() - breaklines_start).count();
+
+  // And taken out again, each edit only changes the triangles around it
+  const auto unbreak_start = Clock::now();
+  for (size_t i = 0; i < endpoints.size(); i += 2) {
+    cdt.RemoveConstraint(endpoints[i], endpoints[i + 1]);
+  }
+  const double unbreak =
+    std::chrono::duration<double, std::milli>(Clock::now() - unbreak_start).count();
+  const auto remove_start = Clock::now();
+  for (size_t i = num_points; i < steiner.size(); i++) {
+    cdt.RemovePoint(steiner[i]);
+  }
+  const double remove =
+    std::chrono::duration<double, std::milli>(Clock::now() - remove_start).count();
+
+  std::printf("%-12s %8s %12s %12s %8s\n", "incremental", "count", "sweep (ms)", "edit (ms)",
+              "speedup");
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "points", wave, sweep, insert, sweep / insert);
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "breaklines", num_breaklines, sweep,
+              breaklines, sweep / breaklines);
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "unbreak", num_breaklines, sweep, unbreak,
+              sweep / unbreak);
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "remove", wave, sweep, remove,
+              sweep / remove);
+  for (Point* point : steiner) {
+    delete point;
+  }
+  for (Point* point : endpoints) {
+    delete point;
+  }
+  for (Point* point : polyline) {
+    delete point;
+  }
+}
+
+void BenchmarkMoving()
+{
+  // Steiner points in an ellipse that is slowly warped, like the frames of an animation
+  const size_t num_points = 10000, frames = 20;
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> random(0, 1);
+  const std::vector<Point*> polyline = Ellipse(200);
+  std::vector<Point*> steiner;
+  for (size_t i = 0; i < num_points; i++) {
+    const double angle = 2 * pi * random(generator);
+    const double radius = 0.95 * std::sqrt(random(generator));
+    steiner.push_back(new Point(3 * radius * std::cos(angle), 2 * radius * std::sin(angle)));
+  }
+  std::vector<Point*> points = polyline;
+  points.insert(points.end(), steiner.begin(), steiner.end());
+  std::vector<Point> rest;
+  for (Point* point : points) {
+    rest.push_back(*point);
+  }
+  const auto warp = [&](size_t frame) {
+    const double time = 0.01 * frame;
+    for (size_t i = 0; i < points.size(); i++) {
+      const double scale = 1 + 0.05 * std::sin(rest[i].y + time);
+      points[i]->set(scale * rest[i].x, rest[i].y + 0.02 * std::sin(rest[i].x + 2 * time));
+    }
+  };
+
+  double sweep = 0;
+  for (size_t frame = 1; frame <= frames; frame++) {
+    warp(frame);
+    const auto start = Clock::now();
+    {
+      CDT cdt(polyline);
+      for (Point* point : steiner) {
+        cdt.AddPoint(point);
+      }
+      cdt.Triangulate();
+    }
+    sweep += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    for (Point* point : polyline) {
+      point->edge_list.clear();
+    }
+  }
+
+  warp(0);
+  CDT cdt(polyline);
+  for (Point* point : steiner) {
+    cdt.AddPoint(point);
+  }
+  cdt.Triangulate();
+  double repair = 0;
+  size_t repaired = 0;
+  for (size_t frame = 1; frame <= frames; frame++) {
+    warp(frame);
+    const auto start = Clock::now();
+    repaired += cdt.Retriangulate();
+    repair += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  std::printf("%-12s %8s %12s %12s %8s\n", "moving", "frames", "sweep (ms)", "repair (ms)",
+              "speedup");
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx (%zu repaired)\n", "points", frames,
+              sweep / frames, repair / frames, sweep / repair, repaired);
+  for (Point* point : points) {
+    delete point;
+  }
+}
+
+
+void BenchmarkCache()
+{
+  // A tile with a few templates placed many times at different positions and sizes
+  const size_t placements = 1000;
+  const std::vector<std::vector<Point*>> templates{ Star(12), RoundedBox(8), Ellipse(100) };
+  std::mt19937 generator(4);
+  std::uniform_real_distribution<double> random(0, 1);
+  std::vector<std::vector<Point*>> tile;
+  for (size_t i = 0; i < placements; i++) {
+    const std::vector<Point*>& shape = templates[i % templates.size()];
+    const double x = 1000 * random(generator), y = 1000 * random(generator);
+    const double scale = 0.5 + random(generator);
+    std::vector<Point*> placed;
+    for (const Point* point : shape) {
+      placed.push_back(new Point(x + scale * point->x, y + scale * point->y));
+    }
+    tile.push_back(placed);
+  }
+
+  const double cdt = Measure([&] {
+    for (const auto& polyline : tile) {
+      Triangulate(polyline, true);
+    }
+  });
+  TriangulationCache cache(16);
+  const double cached = Measure([&] {
+    for (const auto& polyline : tile) {
+      cache.Triangulate(polyline);
+    }
+  });
+  const CacheStatistics statistics = cache.GetStatistics();
+  std::printf("%-12s %8s %12s %12s %8s\n", "cache", "shapes", "cdt (ms)", "cached (ms)",
+              "speedup");
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx (%zu hits, %zu repaired, %zu misses)\n", "tile",
+              placements, cdt / 1000, cached / 1000, cdt / cached, statistics.hits,
+              statistics.repairs, statistics.misses);
+  for (const auto& shape : templates) {
+    for (Point* point : shape) {
+      delete point;
+    }
+  }
+  for (const auto& polyline : tile) {
+    for (Point* point : polyline) {
+      delete point;
+    }
+  }
+}
+
+void BenchmarkDiskCache()
+{
+  // Cold start of a server: the mesh file is already there from an earlier run
+  const size_t num_points = 20000;
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> random(0, 1);
+  const std::vector<Point*> polyline = Ellipse(200);
+  std::vector<Point*> steiner;
+  for (size_t i = 0; i < num_points; i++) {
+    const double angle = 2 * pi * random(generator);
+    const double radius = 0.95 * std::sqrt(random(generator));
+    steiner.push_back(new Point(3 * radius * std::cos(angle), 2 * radius * std::sin(angle)));
+  }
+
+  const double cdt = Measure([&] {
+    {
+      CDT cdt(polyline);
+      for (Point* point : steiner) {
+        cdt.AddPoint(point);
+      }
+      cdt.Triangulate();
+    }
+    for (Point* point : polyline) {
+      point->edge_list.clear();
+    }
+  });
+  DiskCache cache(".");
+  const std::string path = cache.Triangulate(polyline, {}, steiner).path();
+  const double mapped = Measure([&] { cache.Triangulate(polyline, {}, steiner); });
+  std::remove(path.c_str());
+
+  std::printf("%-12s %8s %12s %12s %8s\n", "disk cache", "points", "cdt (ms)", "mapped (ms)",
+              "speedup");
+  std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "ellipse", polyline.size() + steiner.size(),
+              cdt / 1000, mapped / 1000, cdt / mapped);
+  for (Point* point : steiner) {
+    delete point;
+  }
+  for (Point* point : polyline) {
+    delete point;
+  }
+}
+
+/// How the testbed used to read .dat files: tokenize every line with iostreams
+size_t ParseWithStreams(const std::string& path)
+{
+  size_t points = 0;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line) && !line.empty()) {
+    std::istringstream stream(line);
+    std::vector<std::string> tokens{ std::istream_iterator<std::string>(stream),
+                                     std::istream_iterator<std::string>() };
+    if (tokens.size() >= 2) {
+      double x, y;
+      std::istringstream(tokens[0]) >> x;
+      std::istringstream(tokens[1]) >> y;
+      points += x == x && y == y;
+    }
+  }
+  return points;
+}
+
+void BenchmarkDatFile()
+{
+  // A large export written the same way as the files in testbed/data
+  const std::string generated = "p2t_benchmark.dat";
+  {
+    std::mt19937 generator(6);
+    std::uniform_real_distribution<double> random(-1000, 1000);
+    std::ofstream file(generated);
+    file.precision(17);
+    for (size_t i = 0; i < 200000; i++) {
+      file << random(generator) << ' ' << random(generator) << '\n';
+    }
+  }
+  const std::string files[] = { std::string(P2T_BASE_DIR) + "/testbed/data/debug2.dat",
+                                generated };
+  const char* names[] = { "debug2", "random" };
+
+  std::printf("%-12s %8s %12s %12s %8s\n", ".dat", "MB", "iostream", "DatFile", "speedup");
+  for (size_t i = 0; i < 2; i++) {
+    const double megabytes = MappedFile(files[i]).size() / 1e6;
+    const double streams = Measure([&] { ParseWithStreams(files[i]); });
+    const double mapped = Measure([&] { DatFile file(files[i]); });
+    std::printf("%-12s %8.2f %7.0f MB/s %7.0f MB/s %7.1fx\n", names[i], megabytes,
+                megabytes / streams * 1e6, megabytes / mapped * 1e6, streams / mapped);
+  }
+  std::remove(generated.c_str());
+}
+
+void BenchmarkPolygonReader()
+{
+  // A stream of polygons with a hole each, as a database would export them
+  const size_t num_polygons = 5000;
+  const std::vector<Point*> outline = Ellipse(64);
+  std::string wkb;
+  std::ostringstream wkt;
+  wkt.precision(17);
+  const uint16_t one = 1;
+  const char byte_order = *reinterpret_cast<const char*>(&one); // 1 on little endian machines
+  const auto add = [&wkb](uint32_t value) {
+    wkb.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  for (size_t i = 0; i < num_polygons; i++) {
+    const double x = 10.0 * (i % 100), y = 10.0 * (i / 100);
+    wkb += byte_order;
+    add(3);
+    add(2);
+    wkt << "POLYGON (";
+    for (const double scale : { 1.0, 0.5 }) {
+      add(static_cast<uint32_t>(outline.size() + 1));
+      wkt << (scale == 1 ? "(" : ", (");
+      for (size_t j = 0; j <= outline.size(); j++) {
+        const Point& point = *outline[j % outline.size()];
+        const double coordinates[] = { x + scale * static_cast<double>(point.x),
+                                       y + scale * static_cast<double>(point.y) };
+        wkb.append(reinterpret_cast<const char*>(coordinates), sizeof(coordinates));
+        wkt << (j == 0 ? "" : ", ") << coordinates[0] << ' ' << coordinates[1];
+      }
+      wkt << ")";
+    }
+    wkt << ")\n";
+  }
+
+  struct Triangulator : PolygonVisitor {
+    bool triangulate;
+    size_t triangles = 0;
+    void Visit(const std::vector<Point*>& outline,
+               const std::vector<std::vector<Point*>>& holes) override
+    {
+      if (triangulate) {
+        CDT cdt(outline);
+        cdt.AddHole(holes[0]);
+        cdt.Triangulate();
+        triangles += cdt.GetTriangles().size();
+      }
+    }
+  };
+  std::printf("%-12s %8s %12s %12s %10s\n", "reader", "MB", "read", "+triangulate",
+              "polygons/s");
+  const std::string texts[] = { wkb, wkt.str() };
+  const char* names[] = { "wkb", "wkt" };
+  for (size_t i = 0; i < 2; i++) {
+    const double megabytes = texts[i].size() / 1e6;
+    double times[2];
+    for (const bool triangulate : { false, true }) {
+      times[triangulate] = Measure([&] {
+        std::istringstream in(texts[i]);
+        Triangulator visitor;
+        visitor.triangulate = triangulate;
+        i == 0 ? ReadWkb(in, visitor) : ReadWkt(in, visitor);
+      });
+    }
+    std::printf("%-12s %8.2f %7.0f MB/s %7.0f MB/s %10.0f\n", names[i], megabytes,
+                megabytes / times[0] * 1e6, megabytes / times[1] * 1e6,
+                num_polygons / times[1] * 1e6);
+  }
+  for (Point* point : outline) {
+    delete point;
+  }
+}
+
+void BenchmarkPointCloud()
+{
+  // Today's workaround is a bounding rectangle around the points, added as Steiner points, and
+  // throwing away the triangles with a corner of the rectangle afterwards. That leaves a gap to
+  // the convex hull and the edges the sweep didn't make locally Delaunay, the cloud mode
+  // triangulates the hull and checks every edge.
+  std::printf("%-12s %8s %12s %12s %8s\n", "point cloud", "points", "box (ms)", "cloud (ms)",
+              "speedup");
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> random(-1, 1);
+  for (size_t num_points : { 1000, 10000, 100000 }) {
+    std::vector<Point> points;
+    points.reserve(num_points);
+    for (size_t i = 0; i < num_points; i++) {
+      points.emplace_back(random(generator), random(generator));
+    }
+    std::vector<Point> corners{ { -2, -2 }, { 2, -2 }, { 2, 2 }, { -2, 2 } };
+    const std::vector<Point*> box{ &corners[0], &corners[1], &corners[2], &corners[3] };
+    size_t kept = 0;
+    const double with_box = Measure([&] {
+      {
+        CDT cdt(box);
+        for (Point& point : points) {
+          cdt.AddPoint(&point);
+        }
+        cdt.Triangulate();
+        kept = 0;
+        for (Triangle* t : cdt.GetTriangles()) {
+          if (!t->Contains(box[0]) && !t->Contains(box[1]) && !t->Contains(box[2]) &&
+              !t->Contains(box[3])) {
+            kept++;
+          }
+        }
+      }
+      for (Point& corner : corners) {
+        corner.edge_list.clear();
+      }
+    });
+    size_t triangles = 0;
+    const double cloud = Measure([&] {
+      CDT cdt;
+      for (Point& point : points) {
+        cdt.AddPoint(&point);
+      }
+      cdt.Triangulate();
+      triangles = cdt.GetTriangles().size();
+    });
+    if (triangles < kept) {
+      std::printf("point cloud: %zu triangles, the box kept %zu\n", triangles, kept);
+    }
+    std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "uniform", num_points, with_box / 1000,
+                cloud / 1000, with_box / cloud);
+  }
+}
+
+void BenchmarkRings()
+{
+  // A grid of parcels whose borders are shared polylines, one CDT per parcel against one CDT
+  // with a ring per parcel
+  const int cells = 30, segments = 8;
+  const int size = cells * segments + 1;
+  std::mt19937 generator(6);
+  std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+  std::vector<Point> points;
+  points.reserve(size * size);
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const bool corner = x % segments == 0 && y % segments == 0;
+      points.emplace_back(x + (corner ? 0 : jitter(generator)), y + (corner ? 0 : jitter(generator)));
+    }
+  }
+  const auto at = [&points, size](int x, int y) { return &points[y * size + x]; };
+  std::vector<std::vector<Point*>> parcels;
+  for (int cy = 0; cy < cells; cy++) {
+    for (int cx = 0; cx < cells; cx++) {
+      const int x0 = cx * segments, y0 = cy * segments;
+      const int x1 = x0 + segments, y1 = y0 + segments;
+      std::vector<Point*> ring;
+      for (int x = x0; x < x1; x++) {
+        ring.push_back(at(x, y0));
+      }
+      for (int y = y0; y < y1; y++) {
+        ring.push_back(at(x1, y));
+      }
+      for (int x = x1; x > x0; x--) {
+        ring.push_back(at(x, y1));
+      }
+      for (int y = y1; y > y0; y--) {
+        ring.push_back(at(x0, y));
+      }
+      parcels.push_back(ring);
+    }
+  }
+
+  const double separate = Measure([&] {
+    for (const auto& parcel : parcels) {
+      Triangulate(parcel, false);
+    }
+  });
+  const double rings = Measure([&] {
+    {
+      CDT cdt;
+      for (const auto& parcel : parcels) {
+        cdt.AddRing(parcel);
+      }
+      cdt.Triangulate();
+    }
+    for (const auto& parcel : parcels) {
+      for (Point* point : parcel) {
+        point->edge_list.clear();
+      }
+    }
+  });
+  // The same vertices without any edge: the floor for one shared mesh, which has to build the
+  // convex hull and flip to Delaunay, so rings can only beat one CDT per parcel by what their
+  // labeling saves on top of it
+  std::vector<Point> vertices;
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      if (x % segments == 0 || y % segments == 0) {
+        vertices.push_back(*at(x, y));
+      }
+    }
+  }
+  const double cloud = Measure([&] {
+    CDT cdt;
+    for (Point& vertex : vertices) {
+      cdt.AddPoint(&vertex);
+    }
+    cdt.Triangulate();
+  });
+  std::printf("%-12s %8s %12s %12s %12s %8s\n", "rings", "parcels", "each (ms)", "cloud (ms)",
+              "rings (ms)", "speedup");
+  std::printf("%-12s %8zu %12.2f %12.2f %12.2f %7.1fx\n", "grid", parcels.size(),
+              separate / 1000, cloud / 1000, rings / 1000, separate / rings);
+}
+
+void BenchmarkMultiPolygon()
+{
+  // Star shaped islands, which aren't monotone, one CDT each against all of them in one. Each
+  // small CDT is thrown away before the next one, while the one CDT keeps all the triangles.
+  std::printf("%-12s %8s %12s %12s %8s\n", "multipolygon", "islands", "each (ms)", "one (ms)",
+              "speedup");
+  const std::vector<Point*> star = Star(16);
+  for (int side : { 10, 100 }) {
+    std::vector<Point> points;
+    points.reserve(side * side * star.size());
+    std::vector<std::vector<Point*>> islands;
+    for (int y = 0; y < side; y++) {
+      for (int x = 0; x < side; x++) {
+        std::vector<Point*> island;
+        for (const Point* point : star) {
+          points.emplace_back(point->x + 3 * x, point->y + 3 * y);
+          island.push_back(&points.back());
+        }
+        islands.push_back(island);
+      }
+    }
+    const double each = Measure([&] {
+      for (const auto& island : islands) {
+        Triangulate(island, true);
+      }
+    });
+    const double one = Measure([&] {
+      {
+        CDT cdt;
+        for (const auto& island : islands) {
+          cdt.AddPolyline(island);
+        }
+        cdt.Triangulate();
+      }
+      for (Point& point : points) {
+        point.edge_list.clear();
+      }
+    });
+    std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "star", islands.size(), each / 1000,
+                one / 1000, each / one);
+  }
+  for (Point* point : star) {
+    delete point;
+  }
+}
+
+void BenchmarkSplitIntersections()
+{
+  // The cost of checking clean input for crossings, and dirty input which only triangulates with
+  // splitting enabled
+  std::printf("%-12s %8s %12s %12s %8s\n", "split", "points", "off (ms)", "on (ms)", "ratio");
+  for (size_t num_points : { 1000, 10000 }) {
+    const std::vector<Point*> star = Star(num_points);
+    const auto triangulate = [&star](bool split) {
+      {
+        CDT cdt(star);
+        cdt.SetSplitIntersections(split);
+        cdt.Triangulate();
+      }
+      for (Point* point : star) {
+        point->edge_list.clear();
+      }
+    };
+    const double off = Measure([&] { triangulate(false); });
+    const double on = Measure([&] { triangulate(true); });
+    std::printf("%-12s %8zu %12.2f %12.2f %7.1fx\n", "star", num_points, off / 1000, on / 1000,
+                on / off);
+    for (Point* point : star) {
+      delete point;
+    }
+  }
+
+  std::printf("%-12s %8s %12s %12s\n", "split", "points", "crossings", "on (ms)");
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(0, 1000);
+  for (size_t num_points : { 100, 1000 }) {
+    std::vector<Point*> scribble;
+    for (size_t i = 0; i < num_points; i++) {
+      scribble.push_back(new Point(coordinate(generator), coordinate(generator)));
+    }
+    size_t crossings = 0;
+    const double on = Measure([&] {
+      {
+        CDT cdt(scribble);
+        cdt.SetSplitIntersections(true);
+        cdt.Triangulate();
+        crossings = cdt.GetIntersections().size();
+      }
+      for (Point* point : scribble) {
+        point->edge_list.clear();
+      }
+    });
+    std::printf("%-12s %8zu %12zu %12.2f\n", "scribble", num_points, crossings, on / 1000);
+    for (Point* point : scribble) {
+      delete point;
+    }
+  }
+}
+
+void BenchmarkValidateInput()
+{
+  // Validating up front against triangulating, which is what finds bad input otherwise
+  std::printf("%-12s %8s %12s %12s %8s\n", "validate", "points", "check (ms)", "cdt (ms)",
+              "share");
+  for (size_t num_points : { 1000, 10000 }) {
+    const std::vector<Point*> star = Star(num_points);
+    const double check = Measure([&star] { ValidateInput({ star }); });
+    const double cdt = Measure([&star] {
+      {
+        CDT cdt(star);
+        cdt.Triangulate();
+      }
+      for (Point* point : star) {
+        point->edge_list.clear();
+      }
+    });
+    std::printf("%-12s %8zu %12.2f %12.2f %7.0f%%\n", "star", num_points, check / 1000,
+                cdt / 1000, 100 * check / cdt);
+    for (Point* point : star) {
+      delete point;
+    }
+  }
+}
+
+void BenchmarkWeldPoints()
+{
+  // Welding clean input, and input with a Steiner point on top of every vertex
+  std::printf("%-12s %8s %12s %12s %12s\n", "weld", "points", "off (ms)", "on (ms)",
+              "dirty (ms)");
+  for (size_t num_points : { 1000, 10000 }) {
+    const std::vector<Point*> star = Star(num_points);
+    std::vector<Point> copies;
+    for (const Point* point : star) {
+      copies.emplace_back(point->x, point->y);
+    }
+    const auto triangulate = [&](double tolerance, bool dirty) {
+      {
+        CDT cdt(star);
+        if (dirty) {
+          for (Point& copy : copies) {
+            cdt.AddPoint(&copy);
+          }
+        }
+        cdt.SetWeldTolerance(tolerance);
+        cdt.Triangulate();
+      }
+      for (Point* point : star) {
+        point->edge_list.clear();
+      }
+    };
+    const double off = Measure([&] { triangulate(-1, false); });
+    const double on = Measure([&] { triangulate(1e-9, false); });
+    const double dirty = Measure([&] { triangulate(1e-9, true); });
+    std::printf("%-12s %8zu %12.2f %12.2f %12.2f\n", "star", num_points, off / 1000, on / 1000,
+                dirty / 1000);
+    for (Point* point : star) {
+      delete point;
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  BenchmarkMonotone();
+  std::printf("\n");
+  BenchmarkSmall();
+  std::printf("\n");
+  BenchmarkIncremental();
+  std::printf("\n");
+  BenchmarkMoving();
+  std::printf("\n");
+  BenchmarkCache();
+  std::printf("\n");
+  BenchmarkDiskCache();
+  std::printf("\n");
+  BenchmarkDatFile();
+  std::printf("\n");
+  BenchmarkPolygonReader();
+  std::printf("\n");
+  BenchmarkPointCloud();
+  std::printf("\n");
+  BenchmarkRings();
+  std::printf("\n");
+  BenchmarkMultiPolygon();
+  std::printf("\n");
+  BenchmarkSplitIntersections();
+  std::printf("\n");
+  BenchmarkValidateInput();
+  std::printf("\n");
+  BenchmarkWeldPoints();
+  return 0;
+}
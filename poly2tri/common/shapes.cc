@@ -35,7 +35,7 @@
 
 namespace p2t {
 
-Point::Point(double x, double y) : x(x), y(y)
+Point::Point(Scalar x, Scalar y) : x(x), y(y)
 {
 }
 
@@ -50,6 +50,7 @@ Triangle::Triangle(Point& a, Point& b, Point& c)
   constrained_edge[0] = constrained_edge[1] = constrained_edge[2] = false;
   delaunay_edge[0] = delaunay_edge[1] = delaunay_edge[2] = false;
   interior_ = false;
+  map_index_ = interior_index_ = 0;
 }
 
 // Update neighbor pointers
@@ -35,16 +35,25 @@
 
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
 
+#ifndef P2T_SCALAR
+#define P2T_SCALAR double
+#endif
+
 namespace p2t {
 
+/// Type of the coordinates: double unless P2T_SCALAR is defined, e.g. as float to halve the
+/// size of the coordinates or as long double for extended precision
+using Scalar = P2T_SCALAR;
+
 struct Edge;
 
 struct P2T_DLL_SYMBOL Point {
 
-  double x, y;
+  Scalar x, y;
 
   /// Default constructor does nothing (for performance).
   Point()
@@ -57,7 +66,7 @@ struct P2T_DLL_SYMBOL Point {
   std::vector<Edge*> edge_list;
 
   /// Construct using coordinates.
-  Point(double x, double y);
+  Point(Scalar x, Scalar y);
 
   /// Set this point to all zeros.
   void set_zero()
@@ -67,7 +76,7 @@ struct P2T_DLL_SYMBOL Point {
   }
 
   /// Set this point to some specified coordinates.
-  void set(double x_, double y_)
+  void set(Scalar x_, Scalar y_)
   {
     x = x_;
     y = y_;
@@ -96,22 +105,22 @@ struct P2T_DLL_SYMBOL Point {
   }
 
   /// Multiply this point by a scalar.
-  void operator *=(double a)
+  void operator *=(Scalar a)
   {
     x *= a;
     y *= a;
   }
 
   /// Get the length of this point (the norm).
-  double Length() const
+  Scalar Length() const
   {
     return sqrt(x * x + y * y);
   }
 
   /// Convert this point into a unit point. Returns the Length.
-  double Normalize()
+  Scalar Normalize()
   {
-    const double len = Length();
+    const Scalar len = Length();
     x /= len;
     y /= len;
     return len;
@@ -210,6 +219,8 @@ bool CircumcicleContains(const Point&) const;
 
 private:
 
+friend class SweepContext;
+
 bool IsCounterClockwise() const;
 
 /// Triangle points
@@ -219,6 +230,29 @@ Triangle* neighbors_[3];
 
 /// Has this triangle been marked as an interior triangle?
 bool interior_;
+
+/// Position in the triangle map and in the interior triangles of the SweepContext, so that it
+/// can take the triangle out without searching
+uint32_t map_index_;
+uint32_t interior_index_;
+};
+
+/**
+ * Receives the interior triangles of a triangulation one at a time, as an alternative
+ * to collecting them with CDT::GetTriangles
+ */
+class P2T_DLL_SYMBOL TriangleVisitor {
+public:
+  virtual ~TriangleVisitor() = default;
+
+  /**
+   * Called once for every interior triangle
+   *
+   * @param indices - indices of the triangle's points, counted in the order the points were
+   *                  added to the CDT (polyline first, then holes and Steiner points)
+   * @param constrained_edge - constrained flags of the edges opposite each point
+   */
+  virtual void Visit(const size_t indices[3], const bool constrained_edge[3]) = 0;
 };
 
 inline bool cmp(const Point* a, const Point* b)
@@ -247,7 +281,7 @@ inline Point operator -(const Point& a, const Point& b)
 }
 
 /// Multiply point by scalar
-inline Point operator *(double s, const Point& a)
+inline Point operator *(Scalar s, const Point& a)
 {
   return Point(s * a.x, s * a.y);
 }
@@ -263,27 +297,27 @@ inline bool operator !=(const Point& a, const Point& b)
 }
 
 /// Peform the dot product on two vectors.
-inline double Dot(const Point& a, const Point& b)
+inline Scalar Dot(const Point& a, const Point& b)
 {
   return a.x * b.x + a.y * b.y;
 }
 
 /// Perform the cross product on two vectors. In 2D this produces a scalar.
-inline double Cross(const Point& a, const Point& b)
+inline Scalar Cross(const Point& a, const Point& b)
 {
   return a.x * b.y - a.y * b.x;
 }
 
 /// Perform the cross product on a point and a scalar. In 2D this produces
 /// a point.
-inline Point Cross(const Point& a, double s)
+inline Point Cross(const Point& a, Scalar s)
 {
   return Point(s * a.y, -s * a.x);
 }
 
 /// Perform the cross product on a scalar and a point. In 2D this produces
 /// a point.
-inline Point Cross(double s, const Point& a)
+inline Point Cross(Scalar s, const Point& a)
 {
   return Point(-s * a.y, s * a.x);
 }
@@ -36,8 +36,12 @@
 
 #include "shapes.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <exception>
+#include <limits>
+#include <utility>
 
 // C99 removes M_PI from math.h
 #ifndef M_PI
@@ -52,6 +56,63 @@ const double EPSILON = 1e-12;
 
 enum Orientation { CW, CCW, COLLINEAR };
 
+/// Type the predicates compute in: at least double, so that float coordinates are subtracted
+/// and multiplied without rounding in most cases
+using Real = decltype(Scalar() + 0.0);
+
+#ifdef P2T_INTEGER_COORDINATES
+#ifndef __SIZEOF_INT128__
+#error "P2T_INTEGER_COORDINATES needs a compiler with __int128"
+#endif
+static_assert(std::numeric_limits<Scalar>::digits > 28,
+              "P2T_INTEGER_COORDINATES needs coordinates that hold integers up to 2^28");
+
+/// __extension__ keeps -Wpedantic quiet about the non-standard type
+__extension__ typedef __int128 Int128;
+
+/**
+ * Largest magnitude of a coordinate with P2T_INTEGER_COORDINATES. Together with the artificial
+ * points around the input this keeps Orient2d within 64 and Incircle within 128 bits.
+ */
+const double kMaxIntegerCoordinate = 1 << 28;
+
+inline bool IsIntegerCoordinate(double value)
+{
+  return std::fabs(value) <= kMaxIntegerCoordinate && std::trunc(value) == value;
+}
+
+/// (pa - pc) x (pb - pc), exact for integer coordinates
+inline int64_t IntegerOrient(const Point& pa, const Point& pb, const Point& pc)
+{
+  const int64_t acx = static_cast<int64_t>(pa.x) - static_cast<int64_t>(pc.x);
+  const int64_t acy = static_cast<int64_t>(pa.y) - static_cast<int64_t>(pc.y);
+  const int64_t bcx = static_cast<int64_t>(pb.x) - static_cast<int64_t>(pc.x);
+  const int64_t bcy = static_cast<int64_t>(pb.y) - static_cast<int64_t>(pc.y);
+  return acx * bcy - acy * bcx;
+}
+
+/// Sign of the incircle determinant, positive if d is inside the circle through the
+/// counter-clockwise a, b and c, exact for integer coordinates
+inline int IntegerIncircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+{
+  const int64_t dx = static_cast<int64_t>(pd.x);
+  const int64_t dy = static_cast<int64_t>(pd.y);
+  const int64_t adx = static_cast<int64_t>(pa.x) - dx;
+  const int64_t ady = static_cast<int64_t>(pa.y) - dy;
+  const int64_t bdx = static_cast<int64_t>(pb.x) - dx;
+  const int64_t bdy = static_cast<int64_t>(pb.y) - dy;
+  const int64_t cdx = static_cast<int64_t>(pc.x) - dx;
+  const int64_t cdy = static_cast<int64_t>(pc.y) - dy;
+
+  const Int128 alift = static_cast<Int128>(adx) * adx + static_cast<Int128>(ady) * ady;
+  const Int128 blift = static_cast<Int128>(bdx) * bdx + static_cast<Int128>(bdy) * bdy;
+  const Int128 clift = static_cast<Int128>(cdx) * cdx + static_cast<Int128>(cdy) * cdy;
+  const Int128 det = alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) +
+                     clift * (adx * bdy - bdx * ady);
+  return det > 0 ? 1 : (det < 0 ? -1 : 0);
+}
+#endif
+
 /**
  * Forumla to calculate signed area<br>
  * Positive if CCW<br>
@@ -62,11 +123,18 @@ enum Orientation { CW, CCW, COLLINEAR };
  *              =  (x1-x3)*(y2-y3) - (y1-y3)*(x2-x3)
  * </pre>
  */
-Orientation Orient2d(const Point& pa, const Point& pb, const Point& pc)
+inline Orientation Orient2d(const Point& pa, const Point& pb, const Point& pc)
 {
-  double detleft = (pa.x - pc.x) * (pb.y - pc.y);
-  double detright = (pa.y - pc.y) * (pb.x - pc.x);
-  double val = detleft - detright;
+#ifdef P2T_INTEGER_COORDINATES
+  const int64_t det = IntegerOrient(pa, pb, pc);
+  if (det == 0) {
+    return COLLINEAR;
+  }
+  return det > 0 ? CCW : CW;
+#else
+  Real detleft = (Real(pa.x) - pc.x) * (Real(pb.y) - pc.y);
+  Real detright = (Real(pa.y) - pc.y) * (Real(pb.x) - pc.x);
+  Real val = detleft - detright;
 
 // Using a tolerance here fails on concave-by-subepsilon boundaries
 //   if (val > -EPSILON && val < EPSILON) {
@@ -77,6 +145,7 @@ Orientation Orient2d(const Point& pa, const Point& pb, const Point& pc)
     return CCW;
   }
   return CW;
+#endif
 }
 
 /*
@@ -113,18 +182,226 @@ bool InScanArea(Point& pa, Point& pb, Point& pc, Point& pd)
 
 */
 
-bool InScanArea(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+inline bool InScanArea(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
 {
-  double oadb = (pa.x - pb.x)*(pd.y - pb.y) - (pd.x - pb.x)*(pa.y - pb.y);
+#ifdef P2T_INTEGER_COORDINATES
+  // No tolerance needed
+  return IntegerOrient(pa, pd, pb) < 0 && IntegerOrient(pa, pd, pc) > 0;
+#else
+  Real oadb = (Real(pa.x) - pb.x)*(Real(pd.y) - pb.y) - (Real(pd.x) - pb.x)*(Real(pa.y) - pb.y);
   if (oadb >= -EPSILON) {
     return false;
   }
 
-  double oadc = (pa.x - pc.x)*(pd.y - pc.y) - (pd.x - pc.x)*(pa.y - pc.y);
+  Real oadc = (Real(pa.x) - pc.x)*(Real(pd.y) - pc.y) - (Real(pd.x) - pc.x)*(Real(pa.y) - pc.y);
   if (oadc <= EPSILON) {
     return false;
   }
   return true;
+#endif
+}
+
+/**
+ * Symbolic perturbation (Simulation of Simplicity) for cocircular points: each point is lifted
+ * above the paraboloid by an infinitesimal amount, the more the earlier it comes in sweep order,
+ * i.e. the lower its index once the points are sorted. The first point ends up outside of the
+ * circle through the others, so any four cocircular points are triangulated the same way,
+ * whichever diagonal is tested, and flipping them can't go back and forth.
+ *
+ * @param points - sorted in sweep order
+ * @return the sign of the perturbed incircle determinant of the points in this order
+ */
+inline bool PerturbedIncircle(const Point* const points[4])
+{
+  const Point& a = *points[0];
+  const Point& b = *points[1];
+  const Point& c = *points[2];
+  const Point& d = *points[3];
+  // The derivatives of the determinant by the lifted coordinates, the first nonzero one decides
+  const Orientation derivatives[] = { Orient2d(b, c, d), Orient2d(c, a, d), Orient2d(a, b, d) };
+  for (const Orientation derivative : derivatives) {
+    if (derivative != COLLINEAR) {
+      return derivative == CCW;
+    }
+  }
+  return Orient2d(a, b, c) == CW;
+}
+
+/// Shewchuk's error bound for the floating point incircle determinant, relative to its permanent
+inline Real IncircleErrorBound()
+{
+  const Real epsilon = std::numeric_limits<Real>::epsilon() / 2;
+  return (10 + 96 * epsilon) * epsilon;
+}
+
+/**
+ * The floating point incircle determinant of the points, positive if d lies inside the
+ * circumcircle of the counter-clockwise triangle a, b, c
+ *
+ * @param permanent - set to the sum of the absolute values of its terms
+ */
+inline Real IncircleDeterminant(const Point& pa, const Point& pb, const Point& pc,
+                                const Point& pd, Real& permanent)
+{
+  const Real adx = Real(pa.x) - pd.x;
+  const Real ady = Real(pa.y) - pd.y;
+  const Real bdx = Real(pb.x) - pd.x;
+  const Real bdy = Real(pb.y) - pd.y;
+  const Real cdx = Real(pc.x) - pd.x;
+  const Real cdy = Real(pc.y) - pd.y;
+
+  const Real bdxcdy = bdx * cdy;
+  const Real cdxbdy = cdx * bdy;
+  const Real cdxady = cdx * ady;
+  const Real adxcdy = adx * cdy;
+  const Real adxbdy = adx * bdy;
+  const Real bdxady = bdx * ady;
+
+  const Real alift = adx * adx + ady * ady;
+  const Real blift = bdx * bdx + bdy * bdy;
+  const Real clift = cdx * cdx + cdy * cdy;
+
+  permanent = alift * (std::fabs(bdxcdy) + std::fabs(cdxbdy)) +
+              blift * (std::fabs(cdxady) + std::fabs(adxcdy)) +
+              clift * (std::fabs(adxbdy) + std::fabs(bdxady));
+  return alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+}
+
+/// Sort the points in sweep order, returns whether that took an odd number of swaps, each of
+/// which changes the sign of the incircle determinant
+inline bool SortInSweepOrder(const Point* points[4])
+{
+  bool odd = false;
+  for (int i = 1; i < 4; i++) {
+    for (int j = i; j > 0 && cmp(points[j], points[j - 1]); j--) {
+      std::swap(points[j], points[j - 1]);
+      odd = !odd;
+    }
+  }
+  return odd;
+}
+
+/**
+ * Whether d lies inside the circumcircle of the counter-clockwise triangle a, b, c. Unlike
+ * Incircle this has no requirements on where d is.
+ *
+ * Points on the circle, or too close to it to tell, are decided by PerturbedIncircle. The
+ * determinant is evaluated with the points in sweep order then, so that it rounds the same way
+ * for every order they are passed in.
+ */
+inline bool InCircumcircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+{
+#ifdef P2T_INTEGER_COORDINATES
+  const int sign = IntegerIncircle(pa, pb, pc, pd);
+  if (sign != 0) {
+    return sign > 0;
+  }
+  const Point* points[] = { &pa, &pb, &pc, &pd };
+  const bool odd = SortInSweepOrder(points);
+  return PerturbedIncircle(points) != odd;
+#else
+  Real permanent;
+  Real det = IncircleDeterminant(pa, pb, pc, pd, permanent);
+  // Relative to any of the points the coordinates are at most 2m, with m the largest one relative
+  // to d, so no order of the points has a permanent above 192 m^4, this one not above 12 m^4.
+  // Further from zero than this error plus twice the one in sweep order, the determinant has the
+  // same sign in sweep order.
+  const Real m = std::fmax(std::fmax(std::fabs(Real(pa.x) - pd.x), std::fabs(Real(pa.y) - pd.y)),
+                           std::fmax(std::fmax(std::fabs(Real(pb.x) - pd.x),
+                                               std::fabs(Real(pb.y) - pd.y)),
+                                     std::fmax(std::fabs(Real(pc.x) - pd.x),
+                                               std::fabs(Real(pc.y) - pd.y))));
+  if (std::fabs(det) > IncircleErrorBound() * 512 * (m * m) * (m * m)) {
+    return det > 0;
+  }
+
+  const Point* points[] = { &pa, &pb, &pc, &pd };
+  const bool odd = SortInSweepOrder(points);
+  det = IncircleDeterminant(*points[0], *points[1], *points[2], *points[3], permanent);
+  if (std::fabs(det) > IncircleErrorBound() * permanent) {
+    return (det > 0) != odd;
+  }
+  return PerturbedIncircle(points) != odd;
+#endif
+}
+
+/**
+ * <b>Requirement</b>:<br>
+ * 1. a,b and c form a triangle.<br>
+ * 2. a and d is know to be on opposite side of bc<br>
+ * <pre>
+ *                a
+ *                +
+ *               / \
+ *              /   \
+ *            b/     \c
+ *            +-------+
+ *           /    d    \
+ *          /           \
+ * </pre>
+ * <b>Fact</b>: d has to be in area B to have a chance to be inside the circle formed by
+ *  a,b and c<br>
+ *  d is outside B if orient2d(a,b,d) or orient2d(c,a,d) is CW<br>
+ *  This preknowledge gives us a way to optimize the incircle test
+ * @param a - triangle point, opposite d
+ * @param b - triangle point
+ * @param c - triangle point
+ * @param d - point opposite a
+ * @return true if d is inside circle, false if outside. Ties are broken like in InCircumcircle.
+ */
+inline bool Incircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+{
+#ifdef P2T_INTEGER_COORDINATES
+  return IntegerOrient(pa, pb, pd) > 0 && IntegerOrient(pc, pa, pd) > 0 &&
+         InCircumcircle(pa, pb, pc, pd);
+#else
+  const Real adx = Real(pa.x) - pd.x;
+  const Real ady = Real(pa.y) - pd.y;
+  const Real bdx = Real(pb.x) - pd.x;
+  const Real bdy = Real(pb.y) - pd.y;
+
+  const Real oabd = adx * bdy - bdx * ady;
+
+  if (oabd <= 0)
+    return false;
+
+  const Real cdx = Real(pc.x) - pd.x;
+  const Real cdy = Real(pc.y) - pd.y;
+
+  const Real ocad = cdx * ady - adx * cdy;
+
+  if (ocad <= 0)
+    return false;
+
+  return InCircumcircle(pa, pb, pc, pd);
+#endif
+}
+
+/// Whether the segments from a to b and from c to d have any point in common. Segments sharing
+/// an end point, the same Point object, only intersect if they overlap.
+inline bool SegmentsIntersect(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+  if (&a == &c || &a == &d || &b == &c || &b == &d) {
+    // Adjacent, they only intersect if they overlap
+    const Point& shared = &a == &c || &a == &d ? a : b;
+    const Point& other_ab = &shared == &a ? b : a;
+    const Point& other_cd = &shared == &c ? d : c;
+    return Orient2d(shared, other_ab, other_cd) == COLLINEAR &&
+           Dot(other_ab - shared, other_cd - shared) > 0;
+  }
+  const Orientation o1 = Orient2d(a, b, c);
+  const Orientation o2 = Orient2d(a, b, d);
+  const Orientation o3 = Orient2d(c, d, a);
+  const Orientation o4 = Orient2d(c, d, b);
+  if (o1 == COLLINEAR && o2 == COLLINEAR) {
+    // On the same line, compare the extents along it
+    const Point direction = b - a;
+    const Real t_c = Dot(c - a, direction);
+    const Real t_d = Dot(d - a, direction);
+    const Real length = Dot(direction, direction);
+    return std::max(t_c, t_d) >= 0 && std::min(t_c, t_d) <= length;
+  }
+  return o1 != o2 && o3 != o4;
 }
 
 }
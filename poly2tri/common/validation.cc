@@ -0,0 +1,260 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "validation.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <set>
+#include <utility>
+
+namespace p2t {
+
+namespace {
+
+/// An edge of the input, p is the lower point like in Edge
+struct Segment {
+  const Point* p;
+  const Point* q;
+  InputLocation p_at;
+  InputLocation q_at;
+  /// Where the edge starts in its polyline
+  InputLocation start;
+};
+
+/// Whether c lies strictly between a and b on the line through them
+bool Inside(const Segment& s, const Point& c)
+{
+  return Orient2d(*s.p, *s.q, c) == COLLINEAR && cmp(s.p, &c) && cmp(&c, s.q);
+}
+
+/// Left to right order of the segments on the sweep line, only consistent as long as they don't
+/// cross
+struct LeftOf {
+  using is_transparent = void;
+
+  bool operator()(const Segment* a, const Segment* b) const
+  {
+    if (a == b) {
+      return false;
+    }
+    if (!cmp(b->p, a->p)) {
+      // b starts on a's part of the sweep line, see on which side of a
+      Orientation side = Orient2d(*a->p, *a->q, *b->p);
+      if (side == COLLINEAR) {
+        side = Orient2d(*a->p, *a->q, *b->q);
+      }
+      return side == CW;
+    }
+    Orientation side = Orient2d(*b->p, *b->q, *a->p);
+    if (side == COLLINEAR) {
+      side = Orient2d(*b->p, *b->q, *a->q);
+    }
+    return side == CCW;
+  }
+
+  bool operator()(const Segment* a, const Point* point) const
+  {
+    return Orient2d(*a->p, *a->q, *point) == CW;
+  }
+
+  bool operator()(const Point* point, const Segment* a) const
+  {
+    return Orient2d(*a->p, *a->q, *point) == CCW;
+  }
+};
+
+/// Error for two segments that aren't allowed to meet, if they do
+bool Meet(const Segment& a, const Segment& b, InputError& error)
+{
+  const Orientation a_p = Orient2d(*b.p, *b.q, *a.p);
+  const Orientation a_q = Orient2d(*b.p, *b.q, *a.q);
+  const Orientation b_p = Orient2d(*a.p, *a.q, *b.p);
+  const Orientation b_q = Orient2d(*a.p, *a.q, *b.q);
+  if (a_p != COLLINEAR && a_q != COLLINEAR && b_p != COLLINEAR && b_q != COLLINEAR) {
+    if (a_p == a_q || b_p == b_q) {
+      return false;
+    }
+    error = { InputError::Type::CrossingEdges, a.start, b.start };
+    return true;
+  }
+  if (a_p == COLLINEAR && a_q == COLLINEAR) {
+    // On one line, they may only share an end
+    if (Inside(a, *b.p) || Inside(a, *b.q) || Inside(b, *a.p) || Inside(b, *a.q) ||
+        (*a.p == *b.p && *a.q == *b.q)) {
+      error = { InputError::Type::CrossingEdges, a.start, b.start };
+      return true;
+    }
+    return false;
+  }
+  for (const auto& end : { std::make_pair(b.p, b.p_at), std::make_pair(b.q, b.q_at) }) {
+    if (Inside(a, *end.first)) {
+      error = { InputError::Type::PointOnEdge, end.second, a.start };
+      return true;
+    }
+  }
+  for (const auto& end : { std::make_pair(a.p, a.p_at), std::make_pair(a.q, a.q_at) }) {
+    if (Inside(b, *end.first)) {
+      error = { InputError::Type::PointOnEdge, end.second, b.start };
+      return true;
+    }
+  }
+  return false;
+}
+
+struct Event {
+  const Point* point;
+  /// Ends come first at a point, then Steiner points, then starts
+  enum Kind { END, POINT, START } kind;
+  const Segment* segment;
+  InputLocation at;
+};
+
+} // namespace
+
+std::vector<InputError> ValidateInput(const std::vector<std::vector<Point*>>& polylines,
+                                      const std::vector<Point*>& points)
+{
+  std::vector<InputError> errors;
+
+  std::vector<std::pair<const Point*, InputLocation>> vertices;
+  std::vector<Segment> segments;
+  for (size_t i = 0; i < polylines.size(); i++) {
+    const std::vector<Point*>& polyline = polylines[i];
+    for (size_t j = 0; j < polyline.size(); j++) {
+      const size_t next = j < polyline.size() - 1 ? j + 1 : 0;
+      vertices.emplace_back(polyline[j], InputLocation{ i, j });
+      Segment segment{ polyline[j], polyline[next], { i, j }, { i, next }, { i, j } };
+      if (*segment.p == *segment.q) {
+        // A repeat point
+        continue;
+      }
+      if (cmp(segment.q, segment.p)) {
+        std::swap(segment.p, segment.q);
+        std::swap(segment.p_at, segment.q_at);
+      }
+      segments.push_back(segment);
+    }
+  }
+  for (size_t j = 0; j < points.size(); j++) {
+    vertices.emplace_back(points[j], InputLocation{ polylines.size(), j });
+  }
+
+  // Repeat points end up next to each other
+  std::stable_sort(vertices.begin(), vertices.end(),
+                   [](const std::pair<const Point*, InputLocation>& a,
+                      const std::pair<const Point*, InputLocation>& b) {
+                     return cmp(a.first, b.first);
+                   });
+  for (size_t i = 0, first = 0; i < vertices.size(); i++) {
+    if (*vertices[i].first != *vertices[first].first) {
+      first = i;
+    } else if (i != first) {
+      errors.push_back(
+        { InputError::Type::RepeatPoint, vertices[first].second, vertices[i].second });
+    }
+  }
+
+  std::vector<Event> events;
+  events.reserve(2 * segments.size() + points.size());
+  for (const Segment& segment : segments) {
+    events.push_back({ segment.p, Event::START, &segment, segment.p_at });
+    events.push_back({ segment.q, Event::END, &segment, segment.q_at });
+  }
+  for (size_t j = 0; j < points.size(); j++) {
+    events.push_back({ points[j], Event::POINT, nullptr, { polylines.size(), j } });
+  }
+  std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+    if (*a.point != *b.point) {
+      return cmp(a.point, b.point);
+    }
+    return a.kind < b.kind;
+  });
+
+  using Status = std::set<const Segment*, LeftOf>;
+  Status status;
+  std::vector<Status::iterator> positions(segments.size());
+  const auto position = [&segments, &positions](const Segment* segment) -> Status::iterator& {
+    return positions[segment - segments.data()];
+  };
+  InputError error;
+  const auto meet = [&](Status::iterator a, Status::iterator b) {
+    if (a != status.end() && b != status.end() && Meet(**a, **b, error)) {
+      errors.push_back(error);
+      return true;
+    }
+    return false;
+  };
+  for (const Event& event : events) {
+    switch (event.kind) {
+      case Event::START: {
+        const auto inserted = status.insert(event.segment);
+        if (!inserted.second) {
+          // Overlapping
+          errors.push_back({ InputError::Type::CrossingEdges, (*inserted.first)->start,
+                             event.segment->start });
+          return errors;
+        }
+        const Status::iterator it = inserted.first;
+        position(event.segment) = it;
+        if (meet(it, std::next(it)) ||
+            (it != status.begin() && meet(std::prev(it), it))) {
+          return errors;
+        }
+        break;
+      }
+      case Event::END: {
+        const Status::iterator it = position(event.segment);
+        const Status::iterator next = status.erase(it);
+        if (next != status.begin() && meet(std::prev(next), next)) {
+          return errors;
+        }
+        break;
+      }
+      case Event::POINT: {
+        const Status::iterator it = status.lower_bound(event.point);
+        for (Status::iterator near : { it, it == status.begin() ? status.end() : std::prev(it) }) {
+          if (near != status.end() && Inside(**near, *event.point)) {
+            errors.push_back({ InputError::Type::PointOnEdge, event.at, (*near)->start });
+            return errors;
+          }
+        }
+        break;
+      }
+    }
+  }
+  return errors;
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#pragma once
+
+#include "dll_symbol.h"
+#include "shapes.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace p2t {
+
+/// A vertex of the input: the index of its polyline and its index in there
+struct P2T_DLL_SYMBOL InputLocation {
+  size_t polyline;
+  size_t index;
+};
+
+/// What ValidateInput found wrong with the input
+struct P2T_DLL_SYMBOL InputError {
+  enum class Type {
+    /// Two points at the same coordinates, first and second are consecutive in a polyline for
+    /// a zero-length edge
+    RepeatPoint,
+    /// The point first lies on the edge from second to the next point of its polyline, e.g. a
+    /// hole touching the outer polyline
+    PointOnEdge,
+    /// The edges starting at first and second cross or overlap
+    CrossingEdges
+  };
+
+  Type type;
+  InputLocation first;
+  InputLocation second;
+};
+
+/**
+ * Check input for CDT before triangulating it, which would throw from somewhere inside of the
+ * sweep or give a broken mesh otherwise. The edges are swept once in O(n log n). As crossing
+ * edges leave the order of the sweep undefined from there on, at most one CrossingEdges or
+ * PointOnEdge error is found, repeat points are all reported.
+ *
+ * @param polylines - the outer polylines and holes
+ * @param points - Steiner points, their location has the polyline index polylines.size()
+ * @return the errors, empty if the input can be triangulated
+ */
+P2T_DLL_SYMBOL std::vector<InputError> ValidateInput(
+  const std::vector<std::vector<Point*>>& polylines, const std::vector<Point*>& points = {});
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "dat_file.h"
+
+#include "mapped_file.h"
+#include "number.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace p2t {
+
+namespace {
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string InvalidToken(const char* begin, const char* end, size_t line)
+{
+  const char* token_end = begin;
+  while (token_end != end && !IsSpace(*token_end) && *token_end != '\n') {
+    ++token_end;
+  }
+  return "DatFile - invalid token [" + std::string(begin, token_end) + "] in line " +
+         std::to_string(line);
+}
+
+} // namespace
+
+DatFile::DatFile(const std::string& path)
+{
+  const MappedFile file(path);
+  *this = Parse(file.data(), file.size());
+}
+
+DatFile DatFile::Parse(const char* data, size_t size)
+{
+  enum Section {
+    Polyline,
+    Hole,
+    Steiner,
+  };
+  // Start of each section in points_, the pointers are set when all points are there
+  std::vector<std::pair<Section, size_t>> sections{ { Polyline, 0 } };
+
+  DatFile result;
+  result.points_.reserve(size / 24);
+  const char* p = data;
+  const char* const end = data + size;
+  for (size_t line = 1; p != end; line++) {
+    while (p != end && IsSpace(*p)) {
+      ++p;
+    }
+    if (p == end || *p == '\n') {
+      break;
+    }
+    if (*p == 'H' || *p == 'S') {
+      const char* word = p;
+      while (p != end && !IsSpace(*p) && *p != '\n') {
+        ++p;
+      }
+      const std::string token(word, p);
+      if (token == "HOLE") {
+        sections.emplace_back(Hole, result.points_.size());
+      } else if (token == "STEINER") {
+        sections.emplace_back(Steiner, result.points_.size());
+      } else {
+        throw std::runtime_error(InvalidToken(word, end, line));
+      }
+    } else {
+      double x, y;
+      const char* token = p;
+      p = ParseDouble(p, end, x);
+      if (!p || p == end || !IsSpace(*p)) {
+        throw std::runtime_error(InvalidToken(token, end, line));
+      }
+      while (p != end && IsSpace(*p)) {
+        ++p;
+      }
+      token = p;
+      p = ParseDouble(p, end, y);
+      if (!p || (p != end && !IsSpace(*p) && *p != '\n')) {
+        throw std::runtime_error(InvalidToken(token, end, line));
+      }
+      result.points_.emplace_back(x, y);
+    }
+    // Further tokens on the line are ignored
+    while (p != end && *p != '\n') {
+      ++p;
+    }
+    if (p != end) {
+      ++p;
+    }
+  }
+
+  sections.emplace_back(Polyline, result.points_.size()); // only marks the end
+  for (size_t i = 0; i + 1 < sections.size(); i++) {
+    std::vector<Point*>* list = &result.polyline_;
+    if (sections[i].first == Hole) {
+      result.holes_.emplace_back();
+      list = &result.holes_.back();
+    } else if (sections[i].first == Steiner) {
+      list = &result.steiner_;
+    }
+    for (size_t j = sections[i].second; j < sections[i + 1].second; j++) {
+      list->push_back(&result.points_[j]);
+    }
+  }
+  return result;
+}
+
+}
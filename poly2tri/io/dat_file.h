@@ -0,0 +1,101 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace p2t {
+
+/**
+ * Polygon read from a .dat file like the ones in testbed/data: one "x y" pair per line for the
+ * polyline, followed by sections starting with a line "HOLE" or "STEINER". A blank line ends
+ * the input.
+ *
+ * All points are stored in one array, the lists of pointers into it can be passed to CDT
+ * directly. Moving keeps them valid, copying isn't possible.
+ */
+class P2T_DLL_SYMBOL DatFile {
+public:
+  /// Map the file and parse it. Throws std::runtime_error if it can't be read or is malformed.
+  explicit DatFile(const std::string& path);
+
+  /// Parse the contents of a .dat file that is already in memory
+  static DatFile Parse(const char* data, size_t size);
+
+  DatFile(DatFile&&) = default;
+  DatFile& operator=(DatFile&&) = default;
+  DatFile(const DatFile&) = delete;
+  DatFile& operator=(const DatFile&) = delete;
+
+  /// All points in the order polyline, holes, Steiner points
+  const std::vector<Point>& points() const;
+
+  const std::vector<Point*>& polyline() const;
+  const std::vector<std::vector<Point*>>& holes() const;
+  const std::vector<Point*>& steiner() const;
+
+private:
+
+  DatFile() = default;
+
+  std::vector<Point> points_;
+  std::vector<Point*> polyline_;
+  std::vector<std::vector<Point*>> holes_;
+  std::vector<Point*> steiner_;
+};
+
+inline const std::vector<Point>& DatFile::points() const
+{
+  return points_;
+}
+
+inline const std::vector<Point*>& DatFile::polyline() const
+{
+  return polyline_;
+}
+
+inline const std::vector<std::vector<Point*>>& DatFile::holes() const
+{
+  return holes_;
+}
+
+inline const std::vector<Point*>& DatFile::steiner() const
+{
+  return steiner_;
+}
+
+}
@@ -0,0 +1,167 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "disk_cache.h"
+
+#include "../sweep/cdt.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace p2t {
+
+namespace {
+
+/// FNV-1a, over the exact bits so that any change of the input gives another file. Coordinates
+/// are added as the doubles that are stored in the file, not as Scalar, whose padding bytes in
+/// long double are undefined.
+class Hash {
+public:
+  void Add(const void* data, size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      value_ = (value_ ^ bytes[i]) * 0x100000001b3ull;
+    }
+  }
+
+  void Add(uint64_t value)
+  {
+    Add(&value, sizeof(value));
+  }
+
+  uint64_t value() const
+  {
+    return value_;
+  }
+
+private:
+  uint64_t value_ = 0xcbf29ce484222325ull;
+};
+
+} // namespace
+
+MappedMesh::MappedMesh(const std::string& path)
+: path_(path), file_(path), view_(file_.data(), file_.size())
+{
+}
+
+DiskCache::DiskCache(std::string directory) : directory_(std::move(directory))
+{
+}
+
+MappedMesh DiskCache::Triangulate(const std::vector<Point*>& polyline,
+                                  const std::vector<std::vector<Point*>>& holes,
+                                  const std::vector<Point*>& steiner)
+{
+  std::vector<const Point*> points(polyline.begin(), polyline.end());
+  Hash hash;
+  hash.Add(polyline.size());
+  hash.Add(holes.size());
+  for (const auto& hole : holes) {
+    hash.Add(hole.size());
+    points.insert(points.end(), hole.begin(), hole.end());
+  }
+  hash.Add(steiner.size());
+  points.insert(points.end(), steiner.begin(), steiner.end());
+  for (const Point* point : points) {
+    const double x = static_cast<double>(point->x);
+    const double y = static_cast<double>(point->y);
+    hash.Add(&x, sizeof(x));
+    hash.Add(&y, sizeof(y));
+  }
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.p2tm", static_cast<unsigned long long>(hash.value()));
+  const std::string path = directory_ + "/" + name;
+  try {
+    MappedMesh mesh(path);
+    const MeshView& view = mesh.view();
+    bool same = view.input_hash() == hash.value() && view.vertex_count() == points.size();
+    for (size_t i = 0; i < points.size() && same; i++) {
+      same = view.vertices()[2 * i] == static_cast<double>(points[i]->x) &&
+             view.vertices()[2 * i + 1] == static_cast<double>(points[i]->y);
+    }
+    if (same) {
+      statistics_.hits++;
+      return mesh;
+    }
+  } catch (std::runtime_error&) {
+    // Not there yet, or written by another version
+  }
+
+  // Triangulate copies, CDT adds edges to the points
+  statistics_.misses++;
+  std::vector<Point> copies;
+  copies.reserve(points.size());
+  for (const Point* point : points) {
+    copies.emplace_back(point->x, point->y);
+  }
+  const auto ring = [&copies](size_t begin, size_t size) {
+    std::vector<Point*> result;
+    for (size_t i = begin; i < begin + size; i++) {
+      result.push_back(&copies[i]);
+    }
+    return result;
+  };
+  CDT cdt(ring(0, polyline.size()));
+  size_t offset = polyline.size();
+  for (const auto& hole : holes) {
+    cdt.AddHole(ring(offset, hole.size()));
+    offset += hole.size();
+  }
+  for (; offset < copies.size(); offset++) {
+    cdt.AddPoint(&copies[offset]);
+  }
+  cdt.Triangulate();
+
+  // Written under another name first, so that other processes never map half a file
+  std::random_device random;
+  const std::string temporary = path + "." + std::to_string(random()) + ".tmp";
+  WriteMeshFile(temporary, hash.value(), copies.data(), copies.size(), cdt.GetTriangles());
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    // Windows doesn't replace existing files, e.g. one of another version
+    std::remove(path.c_str());
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+      std::remove(temporary.c_str());
+    }
+  }
+  return MappedMesh(path);
+}
+
+CacheStatistics DiskCache::GetStatistics() const
+{
+  return statistics_;
+}
+
+} // namespace p2t
@@ -0,0 +1,107 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+#include "mesh_file.h"
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+#include "../sweep/triangulation_cache.h"
+
+#include <string>
+#include <vector>
+
+namespace p2t {
+
+/**
+ * A mesh file mapped into memory
+ */
+class P2T_DLL_SYMBOL MappedMesh {
+public:
+  /// Throws std::runtime_error if the file can't be mapped or isn't a mesh file
+  explicit MappedMesh(const std::string& path);
+
+  const MeshView& view() const;
+
+  const std::string& path() const;
+
+private:
+
+  std::string path_;
+  MappedFile file_;
+  MeshView view_;
+};
+
+/**
+ * Keeps triangulations in a directory across process restarts. Each input gets a mesh file
+ * named after a hash of its points, which is mapped instead of triangulating again.
+ */
+class P2T_DLL_SYMBOL DiskCache {
+public:
+  /**
+   * @param directory - has to exist
+   */
+  explicit DiskCache(std::string directory);
+
+  /**
+   * Map the mesh file for the input, triangulating it and writing the file first if there is
+   * none yet. The vertices of the mesh are the points in the order polyline, holes, Steiner
+   * points. The points aren't modified. Like in the file, their coordinates are compared as
+   * double, long double points that only differ beyond that share a file.
+   *
+   * @param polyline
+   * @param holes
+   * @param steiner
+   */
+  MappedMesh Triangulate(const std::vector<Point*>& polyline,
+                         const std::vector<std::vector<Point*>>& holes = {},
+                         const std::vector<Point*>& steiner = {});
+
+  CacheStatistics GetStatistics() const;
+
+private:
+
+  std::string directory_;
+  CacheStatistics statistics_;
+};
+
+inline const MeshView& MappedMesh::view() const
+{
+  return view_;
+}
+
+inline const std::string& MappedMesh::path() const
+{
+  return path_;
+}
+
+}
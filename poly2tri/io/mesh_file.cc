@@ -0,0 +1,207 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "mesh_file.h"
+
+#include "../sweep/cdt.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace p2t {
+
+MeshView::MeshView(const void* data, size_t size)
+{
+  const char* bytes = static_cast<const char*>(data);
+  if (size < sizeof(MeshFileHeader) || reinterpret_cast<uintptr_t>(bytes) % 8 != 0) {
+    throw std::runtime_error("MeshView - not a mesh file");
+  }
+  header_ = reinterpret_cast<const MeshFileHeader*>(bytes);
+  if (std::memcmp(header_->magic, kMeshFileMagic, sizeof(kMeshFileMagic)) != 0) {
+    throw std::runtime_error("MeshView - not a mesh file");
+  }
+  if (header_->version != kMeshFileVersion) {
+    uint32_t swapped = 0;
+    for (int i = 0; i < 4; i++) {
+      swapped = (swapped << 8) | ((header_->version >> (8 * i)) & 0xff);
+    }
+    if (swapped == kMeshFileVersion) {
+      throw std::runtime_error("MeshView - written with the other byte order");
+    }
+    throw std::runtime_error("MeshView - unsupported version");
+  }
+  const size_t vertex_bytes = 2 * sizeof(double) * header_->vertex_count;
+  const size_t index_bytes = 3 * sizeof(uint32_t) * header_->triangle_count;
+  if (size != sizeof(MeshFileHeader) + vertex_bytes + 2 * index_bytes + header_->triangle_count) {
+    throw std::runtime_error("MeshView - wrong size");
+  }
+  bytes += sizeof(MeshFileHeader);
+  vertices_ = reinterpret_cast<const double*>(bytes);
+  bytes += vertex_bytes;
+  triangles_ = reinterpret_cast<const uint32_t*>(bytes);
+  bytes += index_bytes;
+  neighbors_ = reinterpret_cast<const uint32_t*>(bytes);
+  bytes += index_bytes;
+  constrained_ = reinterpret_cast<const uint8_t*>(bytes);
+
+  // The navigation doesn't check indices, a damaged file mustn't make it read out of bounds
+  const size_t corner_count = 3 * static_cast<size_t>(header_->triangle_count);
+  for (size_t i = 0; i < corner_count; i++) {
+    if (triangles_[i] >= header_->vertex_count) {
+      throw std::runtime_error("MeshView - vertex index out of range");
+    }
+    if (neighbors_[i] >= header_->triangle_count && neighbors_[i] != kNoNeighbor) {
+      throw std::runtime_error("MeshView - neighbor index out of range");
+    }
+  }
+}
+
+namespace {
+
+/// Write the triangles, vertex_index gives the number of a point of a triangle
+template <class VertexIndex>
+void Write(std::ostream& out, uint64_t input_hash, const std::vector<const Point*>& vertices,
+           const std::vector<Triangle*>& triangles, VertexIndex vertex_index)
+{
+  MeshFileHeader header;
+  std::memcpy(header.magic, kMeshFileMagic, sizeof(kMeshFileMagic));
+  header.version = kMeshFileVersion;
+  header.input_hash = input_hash;
+  header.vertex_count = static_cast<uint32_t>(vertices.size());
+  header.triangle_count = static_cast<uint32_t>(triangles.size());
+
+  std::vector<double> coordinates;
+  coordinates.reserve(2 * vertices.size());
+  for (const Point* vertex : vertices) {
+    coordinates.push_back(vertex->x);
+    coordinates.push_back(vertex->y);
+  }
+  std::unordered_map<const Triangle*, uint32_t> triangle_index;
+  triangle_index.reserve(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i++) {
+    triangle_index.emplace(triangles[i], static_cast<uint32_t>(i));
+  }
+  std::vector<uint32_t> corners, neighbors;
+  std::vector<uint8_t> constrained;
+  corners.reserve(3 * triangles.size());
+  neighbors.reserve(3 * triangles.size());
+  constrained.reserve(triangles.size());
+  for (Triangle* t : triangles) {
+    uint8_t bits = 0;
+    for (int i = 0; i < 3; i++) {
+      corners.push_back(vertex_index(t->GetPoint(i)));
+      const auto neighbor = triangle_index.find(t->GetNeighbor(i));
+      neighbors.push_back(neighbor != triangle_index.end() ? neighbor->second : kNoNeighbor);
+      if (t->constrained_edge[i]) {
+        bits |= 1 << i;
+      }
+    }
+    constrained.push_back(bits);
+  }
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(coordinates.data()),
+            coordinates.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(corners.data()), corners.size() * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(neighbors.data()), neighbors.size() * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(constrained.data()), constrained.size());
+  if (!out) {
+    throw std::runtime_error("WriteMesh - can't write");
+  }
+}
+
+} // namespace
+
+void WriteMesh(std::ostream& out, CDT& cdt, uint64_t input_hash)
+{
+  const std::vector<Triangle*> triangles = cdt.GetTriangles();
+  const std::vector<Point*> input = cdt.GetInputPoints();
+  std::vector<const Point*> vertices(input.begin(), input.end());
+  std::unordered_map<const Point*, uint32_t> vertex_index;
+  vertex_index.reserve(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    vertex_index.emplace(vertices[i], static_cast<uint32_t>(i));
+  }
+  // Points inserted after triangulating
+  for (Triangle* t : triangles) {
+    for (int i = 0; i < 3; i++) {
+      if (vertex_index.emplace(t->GetPoint(i), static_cast<uint32_t>(vertices.size())).second) {
+        vertices.push_back(t->GetPoint(i));
+      }
+    }
+  }
+  Write(out, input_hash, vertices, triangles,
+        [&vertex_index](const Point* point) { return vertex_index.at(point); });
+}
+
+void WriteMesh(std::ostream& out, const std::vector<Point*>& vertices,
+               const std::vector<Triangle*>& triangles, uint64_t input_hash)
+{
+  std::unordered_map<const Point*, uint32_t> vertex_index;
+  vertex_index.reserve(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    vertex_index.emplace(vertices[i], static_cast<uint32_t>(i));
+  }
+  Write(out, input_hash, std::vector<const Point*>(vertices.begin(), vertices.end()), triangles,
+        [&vertex_index](const Point* point) {
+          const auto it = vertex_index.find(point);
+          if (it == vertex_index.end()) {
+            throw std::runtime_error("WriteMesh - point not in the vertex list");
+          }
+          return it->second;
+        });
+}
+
+void WriteMeshFile(const std::string& path, uint64_t input_hash, const Point* vertices,
+                   size_t vertex_count, const std::vector<Triangle*>& triangles)
+{
+  std::vector<const Point*> list;
+  list.reserve(vertex_count);
+  for (size_t i = 0; i < vertex_count; i++) {
+    list.push_back(vertices + i);
+  }
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("WriteMeshFile - can't open " + path);
+  }
+  Write(file, input_hash, list, triangles, [vertices, vertex_count](const Point* point) {
+    if (point < vertices || point >= vertices + vertex_count) {
+      throw std::runtime_error("WriteMeshFile - point not in the vertex array");
+    }
+    return static_cast<uint32_t>(point - vertices);
+  });
+  if (!file.flush()) {
+    throw std::runtime_error("WriteMeshFile - can't write " + path);
+  }
+}
+
+} // namespace p2t
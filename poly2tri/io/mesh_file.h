@@ -0,0 +1,296 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace p2t {
+
+class CDT;
+
+/// First bytes of every mesh file
+const char kMeshFileMagic[4] = { 'P', '2', 'T', 'M' };
+/// Mesh files of other versions are rejected. Increase when the layout changes.
+const uint32_t kMeshFileVersion = 1;
+/// Neighbor index of edges on the border
+const uint32_t kNoNeighbor = 0xffffffff;
+
+/**
+ * Start of a mesh file. It is followed by, in native byte order and without padding:
+ *
+ *   double   vertices[2 * vertex_count]      x and y of each vertex
+ *   uint32_t triangles[3 * triangle_count]   counter-clockwise vertex indices
+ *   uint32_t neighbors[3 * triangle_count]   triangle across the edge opposite each corner
+ *   uint8_t  constrained[triangle_count]     bit i set if the edge opposite corner i is
+ *                                            constrained
+ *
+ * Every array is aligned to its element size if the file is, so a mapped file can be used
+ * in place.
+ */
+struct MeshFileHeader {
+  char magic[4];
+  uint32_t version;
+  /// Identifies the input that was triangulated, e.g. a hash of it
+  uint64_t input_hash;
+  uint32_t vertex_count;
+  uint32_t triangle_count;
+};
+
+static_assert(sizeof(MeshFileHeader) == 24, "MeshFileHeader has to be packed");
+
+/**
+ * Read-only view of a mesh file in memory, e.g. a MappedFile. Nothing is copied, the indices
+ * are only checked against the counts once.
+ *
+ * Besides the raw arrays it offers the navigation of Triangle, with triangles and vertices
+ * given by index: GetPoint, GetNeighbor, NeighborCW, ...
+ */
+class P2T_DLL_SYMBOL MeshView {
+public:
+  /**
+   * @param data - the file contents, aligned to 8 bytes
+   * @param size
+   * Throws std::runtime_error if it isn't a mesh file of kMeshFileVersion or an index is out of
+   * range
+   */
+  MeshView(const void* data, size_t size);
+
+  uint64_t input_hash() const;
+
+  size_t vertex_count() const;
+
+  size_t triangle_count() const;
+
+  /// x and y of every vertex
+  const double* vertices() const;
+
+  /// Three counter-clockwise vertex indices per triangle
+  const uint32_t* triangles() const;
+
+  /// neighbors()[3 * t + i] is across the edge opposite corner i of triangle t, kNoNeighbor on
+  /// the border
+  const uint32_t* neighbors() const;
+
+  /// Bit i of constrained()[t] is set if the edge opposite corner i of triangle t is constrained
+  const uint8_t* constrained() const;
+
+  /// x and y of vertex v
+  const double* GetVertex(uint32_t v) const;
+
+  /// Vertex at corner index of triangle t
+  uint32_t GetPoint(uint32_t t, int index) const;
+  /// Triangle across the edge opposite corner index of triangle t, kNoNeighbor on the border
+  uint32_t GetNeighbor(uint32_t t, int index) const;
+  /// Whether the edge opposite corner index of triangle t is constrained
+  bool IsConstrained(uint32_t t, int index) const;
+
+  /// Corner of triangle t at vertex v, -1 if it isn't one
+  int Index(uint32_t t, uint32_t v) const;
+  /// Corner of triangle t opposite the edge from v1 to v2, -1 if it isn't one
+  int EdgeIndex(uint32_t t, uint32_t v1, uint32_t v2) const;
+
+  // These throw std::runtime_error if v isn't a corner of t
+  uint32_t PointCW(uint32_t t, uint32_t v) const;
+  uint32_t PointCCW(uint32_t t, uint32_t v) const;
+  /// Neighbor across the edge from v to PointCW(t, v)
+  uint32_t NeighborCW(uint32_t t, uint32_t v) const;
+  /// Neighbor across the edge from v to PointCCW(t, v)
+  uint32_t NeighborCCW(uint32_t t, uint32_t v) const;
+  /// Neighbor across the edge opposite v
+  uint32_t NeighborAcross(uint32_t t, uint32_t v) const;
+
+private:
+
+  /// Index, but throws std::runtime_error naming where if v isn't a corner of t
+  int CheckedIndex(uint32_t t, uint32_t v, const char* where) const;
+
+  const MeshFileHeader* header_;
+  const double* vertices_;
+  const uint32_t* triangles_;
+  const uint32_t* neighbors_;
+  const uint8_t* constrained_;
+};
+
+/**
+ * Write the interior triangles of a CDT as mesh, straight from the triangles and points of the
+ * sweep. Vertex i is point i of CDT::GetInputPoints, so indices refer to the input; the ones no
+ * triangle uses, e.g. welded points, are written too and have to be alive. Points inserted after
+ * triangulating follow in the order they are first used by a triangle.
+ *
+ * @param out - a binary stream
+ * @param cdt - triangulated, not visited
+ * @param input_hash - stored in the header
+ */
+P2T_DLL_SYMBOL void WriteMesh(std::ostream& out, CDT& cdt, uint64_t input_hash = 0);
+
+/**
+ * Write triangles as mesh
+ *
+ * @param out - a binary stream
+ * @param vertices - the points of all triangles have to be in this list
+ * @param triangles - neighbors that aren't part of it are treated as border
+ * @param input_hash - stored in the header
+ */
+P2T_DLL_SYMBOL void WriteMesh(std::ostream& out, const std::vector<Point*>& vertices,
+                              const std::vector<Triangle*>& triangles, uint64_t input_hash = 0);
+
+/**
+ * Write triangles as mesh file, for points that are in one array
+ *
+ * @param path
+ * @param input_hash - stored in the header
+ * @param vertices - the points of all triangles have to be in this array
+ * @param vertex_count
+ * @param triangles - neighbors that aren't part of it are treated as border
+ */
+P2T_DLL_SYMBOL void WriteMeshFile(const std::string& path, uint64_t input_hash,
+                                  const Point* vertices, size_t vertex_count,
+                                  const std::vector<Triangle*>& triangles);
+
+inline uint64_t MeshView::input_hash() const
+{
+  return header_->input_hash;
+}
+
+inline size_t MeshView::vertex_count() const
+{
+  return header_->vertex_count;
+}
+
+inline size_t MeshView::triangle_count() const
+{
+  return header_->triangle_count;
+}
+
+inline const double* MeshView::vertices() const
+{
+  return vertices_;
+}
+
+inline const uint32_t* MeshView::triangles() const
+{
+  return triangles_;
+}
+
+inline const uint32_t* MeshView::neighbors() const
+{
+  return neighbors_;
+}
+
+inline const uint8_t* MeshView::constrained() const
+{
+  return constrained_;
+}
+
+inline const double* MeshView::GetVertex(uint32_t v) const
+{
+  return vertices_ + 2 * v;
+}
+
+inline uint32_t MeshView::GetPoint(uint32_t t, int index) const
+{
+  return triangles_[3 * t + index];
+}
+
+inline uint32_t MeshView::GetNeighbor(uint32_t t, int index) const
+{
+  return neighbors_[3 * t + index];
+}
+
+inline bool MeshView::IsConstrained(uint32_t t, int index) const
+{
+  return (constrained_[t] >> index) & 1;
+}
+
+inline int MeshView::Index(uint32_t t, uint32_t v) const
+{
+  for (int i = 0; i < 3; i++) {
+    if (triangles_[3 * t + i] == v) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+inline int MeshView::CheckedIndex(uint32_t t, uint32_t v, const char* where) const
+{
+  const int index = Index(t, v);
+  if (index < 0) {
+    throw std::runtime_error(std::string(where) + " - vertex not in triangle");
+  }
+  return index;
+}
+
+inline int MeshView::EdgeIndex(uint32_t t, uint32_t v1, uint32_t v2) const
+{
+  const int i1 = Index(t, v1);
+  const int i2 = Index(t, v2);
+  if (i1 < 0 || i2 < 0 || i1 == i2) {
+    return -1;
+  }
+  return 3 - i1 - i2;
+}
+
+inline uint32_t MeshView::PointCW(uint32_t t, uint32_t v) const
+{
+  return GetPoint(t, (CheckedIndex(t, v, "MeshView::PointCW") + 2) % 3);
+}
+
+inline uint32_t MeshView::PointCCW(uint32_t t, uint32_t v) const
+{
+  return GetPoint(t, (CheckedIndex(t, v, "MeshView::PointCCW") + 1) % 3);
+}
+
+inline uint32_t MeshView::NeighborCW(uint32_t t, uint32_t v) const
+{
+  return GetNeighbor(t, (CheckedIndex(t, v, "MeshView::NeighborCW") + 1) % 3);
+}
+
+inline uint32_t MeshView::NeighborCCW(uint32_t t, uint32_t v) const
+{
+  return GetNeighbor(t, (CheckedIndex(t, v, "MeshView::NeighborCCW") + 2) % 3);
+}
+
+inline uint32_t MeshView::NeighborAcross(uint32_t t, uint32_t v) const
+{
+  return GetNeighbor(t, CheckedIndex(t, v, "MeshView::NeighborAcross"));
+}
+
+}
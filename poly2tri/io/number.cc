@@ -0,0 +1,130 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "number.h"
+
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace p2t {
+
+namespace {
+
+/// Powers of ten that are exact as double
+const double kPowersOfTen[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+} // namespace
+
+const char* ParseDouble(const char* begin, const char* end, double& value)
+{
+  const char* p = begin;
+  const bool negative = p != end && *p == '-';
+  if (p != end && (*p == '-' || *p == '+')) {
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0; // significant digits in the mantissa
+  int exponent = 0;
+  bool any_digit = false;
+  for (; p != end && IsDigit(*p); ++p) {
+    any_digit = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa != 0;
+    } else {
+      ++exponent;
+      digits = 20; // digits were dropped
+    }
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && IsDigit(*p); ++p) {
+      any_digit = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+        --exponent;
+      } else {
+        digits = 20;
+      }
+    }
+  }
+  if (!any_digit) {
+    return nullptr;
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    const bool negative_exponent = q != end && *q == '-';
+    if (q != end && (*q == '-' || *q == '+')) {
+      ++q;
+    }
+    if (q != end && IsDigit(*q)) {
+      int e = 0;
+      for (; q != end && IsDigit(*q); ++q) {
+        if (e < 100000) {
+          e = e * 10 + (*q - '0');
+        }
+      }
+      exponent += negative_exponent ? -e : e;
+      p = q;
+    }
+  }
+
+  if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+    value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / kPowersOfTen[-exponent] : value * kPowersOfTen[exponent];
+    value = negative ? -value : value;
+    return p;
+  }
+  const std::string token(begin, p);
+  if (*std::localeconv()->decimal_point == '.') {
+    char* token_end;
+    value = std::strtod(token.c_str(), &token_end);
+    return token_end == token.c_str() + token.size() ? p : nullptr;
+  }
+  std::istringstream stream(token);
+  stream.imbue(std::locale::classic());
+  if (!(stream >> value)) {
+    return nullptr;
+  }
+  return p;
+}
+
+}
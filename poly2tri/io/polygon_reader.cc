@@ -0,0 +1,394 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "polygon_reader.h"
+
+#include "number.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace p2t {
+
+namespace {
+
+/// The rings of one polygon in a single array of points, which is reused for every polygon
+class PolygonBuffer {
+public:
+  void Begin()
+  {
+    points_.clear();
+    ring_starts_.clear();
+    skip_ = false;
+  }
+
+  void BeginRing()
+  {
+    ring_starts_.push_back(points_.size());
+  }
+
+  void Add(double x, double y)
+  {
+    points_.emplace_back(x, y);
+  }
+
+  void EndRing()
+  {
+    const size_t start = ring_starts_.back();
+    if (points_.size() - start >= 2 && points_.back().x == points_[start].x &&
+        points_.back().y == points_[start].y) {
+      points_.pop_back();
+    }
+    if (points_.size() - start < 3) {
+      points_.erase(points_.begin() + start, points_.end());
+      ring_starts_.pop_back();
+      // Without an outline the holes would become one
+      skip_ = skip_ || ring_starts_.empty();
+    }
+  }
+
+  void Emit(PolygonVisitor& visitor)
+  {
+    if (skip_ || ring_starts_.empty()) {
+      return;
+    }
+    ring_starts_.push_back(points_.size());
+    holes_.resize(ring_starts_.size() - 2);
+    for (size_t ring = 0; ring + 1 < ring_starts_.size(); ring++) {
+      std::vector<Point*>& list = ring == 0 ? outline_ : holes_[ring - 1];
+      list.clear();
+      for (size_t i = ring_starts_[ring]; i < ring_starts_[ring + 1]; i++) {
+        list.push_back(&points_[i]);
+      }
+    }
+    visitor.Visit(outline_, holes_);
+  }
+
+private:
+
+  std::vector<Point> points_;
+  std::vector<size_t> ring_starts_;
+  /// The outline had less than three points
+  bool skip_ = false;
+  std::vector<Point*> outline_;
+  std::vector<std::vector<Point*>> holes_;
+};
+
+bool IsLittleEndian()
+{
+  const uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+class WkbReader {
+public:
+  WkbReader(std::istream& in, PolygonVisitor& visitor) : in_(in), visitor_(visitor)
+  {
+  }
+
+  void Read()
+  {
+    while (in_.peek() != std::char_traits<char>::eof()) {
+      ReadGeometry(false);
+    }
+  }
+
+private:
+
+  enum Type {
+    Polygon = 3,
+    MultiPolygon = 6,
+    GeometryCollection = 7,
+  };
+
+  void ReadBytes(void* data, size_t size)
+  {
+    if (!in_.read(static_cast<char*>(data), size)) {
+      throw std::runtime_error("ReadWkb - unexpected end of input");
+    }
+  }
+
+  uint32_t ReadUInt32(bool swap)
+  {
+    unsigned char bytes[4];
+    ReadBytes(bytes, 4);
+    if (swap) {
+      std::reverse(bytes, bytes + 4);
+    }
+    uint32_t value;
+    std::memcpy(&value, bytes, 4);
+    return value;
+  }
+
+  /// A polygon is expected inside of a MultiPolygon
+  void ReadGeometry(bool polygon_only)
+  {
+    unsigned char order;
+    ReadBytes(&order, 1);
+    if (order > 1) {
+      throw std::runtime_error("ReadWkb - invalid byte order " + std::to_string(order));
+    }
+    const bool swap = (order == 1) != IsLittleEndian();
+    uint32_t type = ReadUInt32(swap);
+    // EWKB flags
+    int dimensions = 2 + ((type & 0x80000000) != 0) + ((type & 0x40000000) != 0);
+    if (type & 0x20000000) {
+      ReadUInt32(swap); // SRID
+    }
+    type &= 0x0fffffff;
+    // ISO: 1000 for Z, 2000 for M, 3000 for ZM
+    dimensions += type / 1000 == 3 ? 2 : type / 1000 != 0;
+    type %= 1000;
+
+    if (type == Polygon) {
+      ReadPolygon(swap, dimensions);
+    } else if (type == MultiPolygon && !polygon_only) {
+      for (uint32_t n = ReadUInt32(swap); n > 0; n--) {
+        ReadGeometry(true);
+      }
+    } else if (type == GeometryCollection && !polygon_only) {
+      for (uint32_t n = ReadUInt32(swap); n > 0; n--) {
+        ReadGeometry(false);
+      }
+    } else {
+      throw std::runtime_error("ReadWkb - unsupported geometry type " + std::to_string(type));
+    }
+  }
+
+  void ReadPolygon(bool swap, int dimensions)
+  {
+    polygon_.Begin();
+    for (uint32_t rings = ReadUInt32(swap); rings > 0; rings--) {
+      polygon_.BeginRing();
+      // In chunks, so that a broken count doesn't allocate gigabytes before the end is reached
+      const size_t chunk = 1024;
+      for (size_t n = ReadUInt32(swap); n > 0;) {
+        const size_t count = std::min(n, chunk);
+        coordinates_.resize(count * dimensions);
+        ReadBytes(coordinates_.data(), coordinates_.size() * sizeof(double));
+        if (swap) {
+          for (double& coordinate : coordinates_) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(&coordinate);
+            std::reverse(bytes, bytes + sizeof(double));
+          }
+        }
+        for (size_t i = 0; i < count; i++) {
+          polygon_.Add(coordinates_[i * dimensions], coordinates_[i * dimensions + 1]);
+        }
+        n -= count;
+      }
+      polygon_.EndRing();
+    }
+    polygon_.Emit(visitor_);
+  }
+
+  std::istream& in_;
+  PolygonVisitor& visitor_;
+  PolygonBuffer polygon_;
+  std::vector<double> coordinates_;
+};
+
+class WktReader {
+public:
+  WktReader(std::istream& in, PolygonVisitor& visitor) : buffer_(*in.rdbuf()), visitor_(visitor)
+  {
+  }
+
+  void Read()
+  {
+    while (Peek() != std::char_traits<char>::eof()) {
+      ReadGeometry();
+    }
+  }
+
+private:
+
+  /// Next character that isn't whitespace, without consuming it
+  int Peek()
+  {
+    int c = buffer_.sgetc();
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      c = buffer_.snextc();
+    }
+    return c;
+  }
+
+  bool Accept(char c)
+  {
+    if (Peek() != c) {
+      return false;
+    }
+    buffer_.sbumpc();
+    return true;
+  }
+
+  void Expect(char c)
+  {
+    if (!Accept(c)) {
+      const int found = Peek();
+      throw std::runtime_error(std::string("ReadWkt - expected ") + c + " but found " +
+                               (found == std::char_traits<char>::eof()
+                                  ? std::string("the end")
+                                  : std::string(1, static_cast<char>(found))));
+    }
+  }
+
+  bool IsLetter(int c)
+  {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+  }
+
+  /// A keyword in upper case, empty if there is none
+  std::string Word()
+  {
+    std::string word;
+    for (int c = Peek(); IsLetter(c); c = buffer_.snextc()) {
+      word += static_cast<char>(c >= 'a' ? c - 'a' + 'A' : c);
+    }
+    return word;
+  }
+
+  double Number()
+  {
+    token_.clear();
+    for (int c = Peek(); (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' ||
+                         c == 'E';
+         c = buffer_.snextc()) {
+      token_ += static_cast<char>(c);
+    }
+    double value;
+    const char* end = token_.data() + token_.size();
+    if (token_.empty() || ParseDouble(token_.data(), end, value) != end) {
+      throw std::runtime_error("ReadWkt - invalid number [" + token_ + "]");
+    }
+    return value;
+  }
+
+  void ReadGeometry()
+  {
+    std::string type = Word();
+    if (type == "SRID") {
+      // EWKT: SRID=4326;POLYGON(...)
+      Expect('=');
+      Number();
+      Expect(';');
+      type = Word();
+    }
+    // The dimension is either part of the keyword (EWKT) or follows it (ISO)
+    for (const char* suffix : { "ZM", "Z", "M" }) {
+      const size_t length = std::strlen(suffix);
+      if (type.size() > length && type.compare(type.size() - length, length, suffix) == 0) {
+        type.erase(type.size() - length);
+        break;
+      }
+    }
+    std::string word = Word();
+    if (word == "Z" || word == "M" || word == "ZM") {
+      word = Word();
+    }
+    const bool empty = word == "EMPTY";
+    if (!empty && !word.empty()) {
+      throw std::runtime_error("ReadWkt - unexpected [" + word + "]");
+    }
+
+    if (type == "POLYGON") {
+      if (!empty) {
+        ReadPolygon();
+      }
+    } else if (type == "MULTIPOLYGON") {
+      if (!empty) {
+        Expect('(');
+        do {
+          if (Word() != "EMPTY") {
+            ReadPolygon();
+          }
+        } while (Accept(','));
+        Expect(')');
+      }
+    } else if (type == "GEOMETRYCOLLECTION") {
+      if (!empty) {
+        Expect('(');
+        do {
+          ReadGeometry();
+        } while (Accept(','));
+        Expect(')');
+      }
+    } else {
+      throw std::runtime_error("ReadWkt - unsupported geometry type [" + type + "]");
+    }
+  }
+
+  void ReadPolygon()
+  {
+    polygon_.Begin();
+    Expect('(');
+    do {
+      polygon_.BeginRing();
+      Expect('(');
+      do {
+        const double x = Number();
+        const double y = Number();
+        // Z and M
+        while (Peek() != ',' && Peek() != ')') {
+          Number();
+        }
+        polygon_.Add(x, y);
+      } while (Accept(','));
+      Expect(')');
+      polygon_.EndRing();
+    } while (Accept(','));
+    Expect(')');
+    polygon_.Emit(visitor_);
+  }
+
+  std::streambuf& buffer_;
+  PolygonVisitor& visitor_;
+  PolygonBuffer polygon_;
+  std::string token_;
+};
+
+} // namespace
+
+void ReadWkb(std::istream& in, PolygonVisitor& visitor)
+{
+  WkbReader(in, visitor).Read();
+}
+
+void ReadWkt(std::istream& in, PolygonVisitor& visitor)
+{
+  WktReader(in, visitor).Read();
+}
+
+}
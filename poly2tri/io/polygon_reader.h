@@ -0,0 +1,88 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+
+#include <istream>
+#include <vector>
+
+namespace p2t {
+
+/**
+ * Receives the polygons decoded by ReadWkb and ReadWkt one at a time, e.g. to triangulate each
+ * while the rest of the stream hasn't been read yet
+ */
+class P2T_DLL_SYMBOL PolygonVisitor {
+public:
+  virtual ~PolygonVisitor() = default;
+
+  /**
+   * Called once for every polygon with at least three distinct points in its outline. The
+   * closing point of each ring is dropped, so the rings can be passed to CDT as they are.
+   * Interior rings with fewer than three points are left out.
+   *
+   * The points belong to the reader and are reused for the next polygon, they are only valid
+   * during the call.
+   *
+   * @param outline - exterior ring
+   * @param holes - interior rings
+   */
+  virtual void Visit(const std::vector<Point*>& outline,
+                     const std::vector<std::vector<Point*>>& holes) = 0;
+};
+
+/**
+ * Read OGC well-known binary geometries until the end of the stream and pass each polygon to
+ * the visitor as soon as it has been decoded. The stream may hold any number of Polygon,
+ * MultiPolygon and GeometryCollection geometries back to back, in either byte order, with or
+ * without Z and M ordinates (ISO or EWKB with SRID). Z and M are ignored.
+ *
+ * Throws std::runtime_error for other geometry types and truncated input.
+ *
+ * @param in - a binary stream
+ * @param visitor
+ */
+P2T_DLL_SYMBOL void ReadWkb(std::istream& in, PolygonVisitor& visitor);
+
+/**
+ * Read OGC well-known text geometries like "MULTIPOLYGON (((0 0, 4 0, 4 4, 0 0)))" until the end
+ * of the stream, like ReadWkb. Geometries are separated by whitespace. An EWKT prefix like
+ * "SRID=4326;" is skipped.
+ *
+ * @param in
+ * @param visitor
+ */
+P2T_DLL_SYMBOL void ReadWkt(std::istream& in, PolygonVisitor& visitor);
+
+}
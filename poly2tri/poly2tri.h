@@ -32,4 +32,12 @@
 #pragma once
 
 #include "common/shapes.h"
+#include "common/validation.h"
+#include "io/dat_file.h"
+#include "io/disk_cache.h"
+#include "io/mapped_file.h"
+#include "io/mesh_file.h"
+#include "io/polygon_reader.h"
 #include "sweep/cdt.h"
+#include "sweep/small_polygon.h"
+#include "sweep/triangulation_cache.h"
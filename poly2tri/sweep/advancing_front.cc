@@ -41,7 +41,7 @@ AdvancingFront::AdvancingFront(Node& head, Node& tail)
   search_node_ = &head;
 }
 
-Node* AdvancingFront::LocateNode(double x)
+Node* AdvancingFront::LocateNode(Scalar x)
 {
   Node* node = search_node_;
 
@@ -63,7 +63,7 @@ Node* AdvancingFront::LocateNode(double x)
   return nullptr;
 }
 
-Node* AdvancingFront::FindSearchNode(double x)
+Node* AdvancingFront::FindSearchNode(Scalar x)
 {
   (void)x; // suppress compiler warnings "unused parameter 'x'"
   // TODO: implement BST index
@@ -72,9 +72,9 @@ Node* AdvancingFront::FindSearchNode(double x)
 
 Node* AdvancingFront::LocatePoint(const Point* point)
 {
-  const double px = point->x;
+  const Scalar px = point->x;
   Node* node = FindSearchNode(px);
-  const double nx = node->point->x;
+  const Scalar nx = node->point->x;
 
   if (px == nx) {
     if (point != node->point) {
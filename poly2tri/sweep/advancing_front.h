@@ -45,7 +45,7 @@ struct Node {
   Node* next;
   Node* prev;
 
-  double value;
+  Scalar value;
 
   Node(Point& p) : point(&p), triangle(NULL), next(NULL), prev(NULL), value(p.x)
   {
@@ -73,7 +73,7 @@ Node* search();
 void set_search(Node* node);
 
 /// Locate insertion point along advancing front
-Node* LocateNode(double x);
+Node* LocateNode(Scalar x);
 
 Node* LocatePoint(const Point* point);
 
@@ -81,7 +81,7 @@ private:
 
 Node* head_, *tail_, *search_node_;
 
-Node* FindSearchNode(double x);
+Node* FindSearchNode(Scalar x);
 };
 
 inline Node* AdvancingFront::head()
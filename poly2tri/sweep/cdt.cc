@@ -30,6 +30,8 @@
  */
 #include "cdt.h"
 
+#include <stdexcept>
+
 namespace p2t {
 
 CDT::CDT(const std::vector<Point*>& polyline)
@@ -38,18 +40,182 @@ CDT::CDT(const std::vector<Point*>& polyline)
   sweep_ = new Sweep;
 }
 
+CDT::CDT() : CDT(std::vector<Point*>())
+{
+}
+
 void CDT::AddHole(const std::vector<Point*>& polyline)
 {
+  if (sweep_context_->point_cloud()) {
+    throw std::runtime_error("CDT::AddHole - a point cloud has no polyline");
+  }
   sweep_context_->AddHole(polyline);
 }
 
+void CDT::AddPolyline(const std::vector<Point*>& polyline)
+{
+  if (sweep_context_->has_rings()) {
+    throw std::runtime_error("CDT::AddPolyline - can't be combined with rings");
+  }
+  sweep_context_->AddPolyline(polyline);
+}
+
+void CDT::AddRing(const std::vector<Point*>& ring)
+{
+  if (!sweep_context_->point_cloud()) {
+    throw std::runtime_error("CDT::AddRing - only without polyline");
+  }
+  if (ring.size() < 3) {
+    throw std::runtime_error("CDT::AddRing - a ring needs three points");
+  }
+  sweep_context_->AddRing(ring);
+}
+
+void CDT::SetFillRule(FillRule rule)
+{
+  sweep_context_->set_fill_rule(rule);
+}
+
 void CDT::AddPoint(Point* point) {
   sweep_context_->AddPoint(point);
 }
 
+void CDT::SetMonotoneFastPath(bool enabled)
+{
+  sweep_context_->set_monotone_fast_path(enabled);
+}
+
+void CDT::SetSplitIntersections(bool enabled)
+{
+  sweep_context_->set_split_intersections(enabled);
+}
+
+std::vector<Point*> CDT::GetIntersections() const
+{
+  return sweep_context_->intersections();
+}
+
+std::vector<Point*> CDT::GetInputPoints() const
+{
+  return sweep_context_->input_points();
+}
+
+void CDT::SetWeldTolerance(double tolerance)
+{
+  sweep_context_->set_weld_tolerance(tolerance);
+}
+
+std::vector<std::pair<Point*, Point*>> CDT::GetWelds() const
+{
+  return sweep_context_->welds();
+}
+
 void CDT::Triangulate()
 {
+  if (!sweep_) {
+    throw std::runtime_error("CDT::Triangulate - already compacted");
+  }
   sweep_->Triangulate(*sweep_context_);
+  UpdatePeakMemoryUsage();
+}
+
+void CDT::Triangulate(TriangleVisitor& visitor)
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::Triangulate - already compacted");
+  }
+  sweep_->Triangulate(*sweep_context_, &visitor);
+  UpdatePeakMemoryUsage();
+}
+
+void CDT::InsertPoint(Point* point)
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::InsertPoint - already compacted");
+  }
+  if (!sweep_context_->IsTriangulated()) {
+    throw std::runtime_error("CDT::InsertPoint - not triangulated");
+  }
+  sweep_->InsertPoint(*sweep_context_, *point);
+}
+
+void CDT::InsertConstraint(Point* p, Point* q)
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::InsertConstraint - already compacted");
+  }
+  if (!sweep_context_->IsTriangulated()) {
+    throw std::runtime_error("CDT::InsertConstraint - not triangulated");
+  }
+  sweep_->InsertConstraint(*sweep_context_, *p, *q);
+}
+
+void CDT::RemovePoint(Point* point)
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::RemovePoint - already compacted");
+  }
+  if (!sweep_context_->IsTriangulated()) {
+    throw std::runtime_error("CDT::RemovePoint - not triangulated");
+  }
+  sweep_->RemovePoint(*sweep_context_, *point);
+}
+
+void CDT::RemoveConstraint(Point* p, Point* q)
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::RemoveConstraint - already compacted");
+  }
+  if (!sweep_context_->IsTriangulated()) {
+    throw std::runtime_error("CDT::RemoveConstraint - not triangulated");
+  }
+  sweep_->RemoveConstraint(*sweep_context_, *p, *q);
+}
+
+bool CDT::Retriangulate()
+{
+  if (!sweep_) {
+    throw std::runtime_error("CDT::Retriangulate - already compacted");
+  }
+  if (!sweep_context_->IsTriangulated()) {
+    throw std::runtime_error("CDT::Retriangulate - not triangulated");
+  }
+  const bool repaired = sweep_->Retriangulate(*sweep_context_);
+  UpdatePeakMemoryUsage();
+  return repaired;
+}
+
+void CDT::Compact()
+{
+  if (!sweep_) {
+    return;
+  }
+  sweep_context_->Compact();
+  // Frees the advancing front nodes
+  delete sweep_;
+  sweep_ = nullptr;
+}
+
+MemoryUsage CDT::GetMemoryUsage() const
+{
+  MemoryUsage usage = sweep_context_->GetMemoryUsage();
+  if (sweep_) {
+    usage.front_nodes = sweep_->GetFrontMemoryUsage(*sweep_context_);
+  }
+  return usage;
+}
+
+MemoryUsage CDT::GetPeakMemoryUsage() const
+{
+  return peak_memory_usage_;
+}
+
+void CDT::UpdatePeakMemoryUsage()
+{
+  const MemoryUsage usage = sweep_->GetPeakMemoryUsage();
+  if (usage.Total() > peak_memory_usage_.Total()) {
+    peak_memory_usage_ = usage;
+  }
 }
 
 std::vector<p2t::Triangle*> CDT::GetTriangles()
@@ -57,9 +223,15 @@ std::vector<p2t::Triangle*> CDT::GetTriangles()
   return sweep_context_->GetTriangles();
 }
 
+std::vector<size_t> CDT::GetTriangleLabels() const
+{
+  return sweep_context_->labels();
+}
+
 std::list<p2t::Triangle*> CDT::GetMap()
 {
-  return sweep_context_->GetMap();
+  const std::vector<Triangle*>& map = sweep_context_->GetMap();
+  return std::list<Triangle*>(map.begin(), map.end());
 }
 
 CDT::~CDT()
@@ -37,6 +37,8 @@
 
 #include "../common/dll_symbol.h"
 
+#include <list>
+
 /**
  *
  * @author Mason Green <mason.green@gmail.com>
@@ -56,6 +58,14 @@ public:
    */
   CDT(const std::vector<Point*>& polyline);
 
+  /**
+   * Constructor for a point cloud: add the points with AddPoint, Triangulate then covers their
+   * convex hull with a Delaunay triangulation. The hull edges are marked as constrained. With
+   * rings added by AddRing only the regions inside of them are kept. It isn't a point cloud
+   * anymore once a polyline is added with AddPolyline.
+   */
+  CDT();
+
    /**
    * Destructor - clean up memory
    */
@@ -68,6 +78,34 @@ public:
    */
   void AddHole(const std::vector<Point*>& polyline);
 
+  /**
+   * Add another outer polyline with non repeating points, e.g. the next island of a
+   * MultiPolygon, so that one CDT holds the triangles of all of them. Holes can be added for any
+   * of them. Polylines whose bounding boxes don't overlap are swept one after the other, each
+   * with its own advancing front. Can also be used for the first polyline of a CDT constructed
+   * without one.
+   *
+   * @param polyline
+   */
+  void AddPolyline(const std::vector<Point*>& polyline);
+
+  /**
+   * Add a closed ring of constrained edges to a CDT constructed without polyline. Rings may
+   * share points and edges, e.g. the boundaries of adjacent parcels, but must not cross.
+   * Triangulate then covers the regions that are inside according to the fill rule in a single
+   * sweep, see GetTriangleLabels.
+   *
+   * @param ring
+   */
+  void AddRing(const std::vector<Point*>& ring);
+
+  /**
+   * Set the rule that decides which regions bounded by rings are inside. EvenOdd by default.
+   *
+   * @param rule
+   */
+  void SetFillRule(FillRule rule);
+
   /**
    * Add a steiner point
    *
@@ -75,16 +113,166 @@ public:
    */
   void AddPoint(Point* point);
 
+  /**
+   * Enable or disable the fast path for y-monotone polylines (which includes all convex
+   * ones) without holes or Steiner points. Disabled by default. GetMap only contains the
+   * interior triangles when it is taken, as there are no artificial points or exterior
+   * triangles then.
+   *
+   * @param enabled
+   */
+  void SetMonotoneFastPath(bool enabled);
+
+  /**
+   * Enable or disable splitting constrained edges that cross each other, disabled by default.
+   * When enabled the intersection points are added as vertices, points lying inside of an edge
+   * split it and overlapping edges are merged, so that self-intersecting polylines, holes
+   * touching the polyline and the like can be triangulated. What is inside follows the even-odd
+   * rule then, overlapping edges count once for each of them. Otherwise such input makes
+   * Triangulate throw.
+   *
+   * @param enabled
+   */
+  void SetSplitIntersections(bool enabled);
+
+  /**
+   * Get the points Triangulate added where constrained edges cross. They are owned by the CDT.
+   * A visitor gets their indices after the ones of the added points, in this order.
+   */
+  std::vector<Point*> GetIntersections() const;
+
+  /**
+   * Get the points in the order they were added, followed by GetIntersections. Points a visitor
+   * gets and the vertices WriteMesh writes are numbered by this list. Welded points and points
+   * taken out with RemovePoint stay in it.
+   */
+  std::vector<Point*> GetInputPoints() const;
+
+  /**
+   * Enable welding points before triangulating, disabled by default. Points at most tolerance
+   * apart, exactly coincident ones with a tolerance of 0, are merged into the one added first,
+   * e.g. a hole sharing vertices with the polyline or Steiner points on top of its vertices.
+   * Edges between merged points are removed. A negative tolerance disables welding.
+   *
+   * @param tolerance
+   */
+  void SetWeldTolerance(double tolerance);
+
+  /**
+   * Get the points Triangulate merged, each with the point it was merged into. Triangles only
+   * refer to the latter.
+   */
+  std::vector<std::pair<Point*, Point*>> GetWelds() const;
+
   /**
    * Triangulate - do this AFTER you've added the polyline, holes, and Steiner points
    */
   void Triangulate();
 
+  /**
+   * Triangulate and pass every interior triangle to the visitor instead of collecting them.
+   * GetTriangles will return an empty vector afterwards.
+   *
+   * @param visitor
+   */
+  void Triangulate(TriangleVisitor& visitor);
+
+  /**
+   * Insert a Steiner point into the finished triangulation. Only the triangles around the
+   * point change, so this is much cheaper than triangulating again. Consecutive points that
+   * are close to each other are found fastest.
+   *
+   * Triangle pointers obtained before stay valid, but the triangles may have changed.
+   *
+   * @param point - must be inside the triangulated area and not a repeat point
+   */
+  void InsertPoint(Point* point);
+
+  /**
+   * Add a constrained edge from p to q to the finished triangulation, e.g. a breakline. Only
+   * the triangles crossed by the segment are replaced.
+   *
+   * Endpoints that aren't vertices yet are inserted like with InsertPoint. Vertices lying on
+   * the segment split it into several constrained edges. Throws if the segment leaves the
+   * triangulated area, crosses another constrained edge or an endpoint repeats a vertex. That
+   * is checked before anything is changed, the triangulation stays as it was then.
+   *
+   * @param p
+   * @param q
+   */
+  void InsertConstraint(Point* p, Point* q);
+
+  /**
+   * Remove a vertex added with AddPoint or InsertPoint from the finished triangulation. Only the
+   * triangles around it are replaced. A vertex lying inside a constrained edge can be removed
+   * too, the edge is kept.
+   *
+   * Throws for vertices on the border of the triangulation and for ends of constrained edges.
+   * The point itself is still owned by the caller.
+   *
+   * Two of the triangles around the point are deleted, pointers to them obtained from
+   * GetTriangles or GetMap before are invalid afterwards; the others are reused. The cost only
+   * depends on the triangles around the point, the last triangles of GetTriangles move into
+   * the places of the deleted ones.
+   *
+   * @param point
+   */
+  void RemovePoint(Point* point);
+
+  /**
+   * Remove the constrained edge from p to q, e.g. one added with InsertConstraint. Throws if
+   * there is no such edge or if it is part of the border of the triangulation.
+   *
+   * @param p
+   * @param q
+   */
+  void RemoveConstraint(Point* p, Point* q);
+
+  /**
+   * Update the triangulation after the points were moved, e.g. for the next frame of an
+   * animation. The points, holes and constrained edges have to stay the same, only their
+   * coordinates change. The previous triangles are repaired with edge flips, which for small
+   * motions is much faster than a new Triangulate. The points are swept again if that isn't
+   * possible, e.g. because the polygon intersects itself now.
+   *
+   * Triangles returned by GetTriangles before stay valid if the triangles could be repaired.
+   *
+   * @return false if the points had to be swept again
+   */
+  bool Retriangulate();
+
+  /**
+   * Compact - do this AFTER Triangulate if the CDT is kept around. Moves the interior triangles
+   * into contiguous storage and frees the sweep state (advancing front, triangle map, edges).
+   * Triangle pointers obtained before are invalidated, GetMap will be empty afterwards. Calling
+   * it again does nothing.
+   */
+  void Compact();
+
+  /**
+   * Get the bytes currently held by this CDT, by category
+   */
+  MemoryUsage GetMemoryUsage() const;
+
+  /**
+   * Get the largest memory usage seen by Triangulate and Retriangulate. It is sampled after
+   * welding, after splitting crossings, on the monotone fast path and at the end,
+   * together with the temporary buffers alive at that point.
+   */
+  MemoryUsage GetPeakMemoryUsage() const;
+
   /**
    * Get CDT triangles
    */
   std::vector<Triangle*> GetTriangles();
 
+  /**
+   * Get the ring each triangle of GetTriangles lies in, as index in the order of AddRing. Nested
+   * rings label a triangle with the innermost one. Empty without rings, after triangulating with
+   * a visitor and once the triangulation was edited.
+   */
+  std::vector<size_t> GetTriangleLabels() const;
+
   /**
    * Get triangle map
    */
@@ -92,12 +280,15 @@ public:
 
   private:
 
+  void UpdatePeakMemoryUsage();
+
   /**
    * Internals
    */
 
   SweepContext* sweep_context_;
   Sweep* sweep_;
+  MemoryUsage peak_memory_usage_;
 
 };
 
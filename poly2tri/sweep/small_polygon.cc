@@ -0,0 +1,291 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "small_polygon.h"
+
+#include "../common/utils.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+namespace p2t {
+
+namespace {
+
+const size_t kMaxTriangles = kSmallPolygonMaxPoints - 2;
+const unsigned char kNone = 0xff;
+
+/// Triangles while they are being built, corners are indices into the polyline
+struct Mesh {
+  unsigned char corners[kMaxTriangles][3];
+  /// neighbors[t][j] is across the edge opposite corners[t][j], kNone on the polyline
+  unsigned char neighbors[kMaxTriangles][3];
+  size_t size;
+};
+
+void Link(Mesh& mesh, unsigned char t, int slot, unsigned char u, unsigned char u_slot)
+{
+  mesh.neighbors[t][slot] = u;
+  if (u != kNone) {
+    mesh.neighbors[u][u_slot] = t;
+  }
+}
+
+void Relink(Mesh& mesh, unsigned char from, unsigned char old_neighbor,
+            unsigned char new_neighbor)
+{
+  if (from == kNone) {
+    return;
+  }
+  for (int j = 0; j < 3; j++) {
+    if (mesh.neighbors[from][j] == old_neighbor) {
+      mesh.neighbors[from][j] = new_neighbor;
+    }
+  }
+}
+
+/// Rotate the corners and neighbors of t so that slot j comes first
+void Rotate(Mesh& mesh, unsigned char t, int j)
+{
+  for (; j > 0; j--) {
+    std::swap(mesh.corners[t][0], mesh.corners[t][1]);
+    std::swap(mesh.corners[t][1], mesh.corners[t][2]);
+    std::swap(mesh.neighbors[t][0], mesh.neighbors[t][1]);
+    std::swap(mesh.neighbors[t][1], mesh.neighbors[t][2]);
+  }
+}
+
+bool IsEar(const Point* const* polyline, const unsigned char* prev, const unsigned char* next,
+           unsigned char v)
+{
+  const Point& a = *polyline[prev[v]];
+  const Point& b = *polyline[v];
+  const Point& c = *polyline[next[v]];
+  if (Orient2d(a, b, c) != CCW) {
+    return false;
+  }
+  for (unsigned char w = next[next[v]]; w != prev[v]; w = next[w]) {
+    const Point& p = *polyline[w];
+    if (Orient2d(a, b, p) != CW && Orient2d(b, c, p) != CW && Orient2d(c, a, p) != CW) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Flip until every edge is locally Delaunay, all triangles are checked at first
+void Legalize(const Point* const* polyline, Mesh& mesh)
+{
+  unsigned char stack[kMaxTriangles];
+  bool queued[kMaxTriangles];
+  size_t stack_size = 0;
+  for (size_t t = 0; t < mesh.size; t++) {
+    stack[stack_size++] = static_cast<unsigned char>(t);
+    queued[t] = true;
+  }
+  while (stack_size > 0) {
+    const unsigned char t = stack[--stack_size];
+    queued[t] = false;
+    for (int j = 0; j < 3; j++) {
+      const unsigned char u = mesh.neighbors[t][j];
+      if (u == kNone) {
+        continue;
+      }
+      int k = 0;
+      while (mesh.neighbors[u][k] != t) {
+        k++;
+      }
+      const Point& v = *polyline[mesh.corners[t][j]];
+      const Point& x = *polyline[mesh.corners[t][(j + 1) % 3]];
+      const Point& y = *polyline[mesh.corners[t][(j + 2) % 3]];
+      const Point& o = *polyline[mesh.corners[u][k]];
+      if (!Incircle(v, x, y, o)) {
+        continue;
+      }
+      // t = (v, x, y) and u = (o, y, x) become t = (v, x, o) and u = (v, o, y)
+      Rotate(mesh, t, j);
+      Rotate(mesh, u, k);
+      const unsigned char across_xo = mesh.neighbors[u][1];
+      const unsigned char across_oy = mesh.neighbors[u][2];
+      const unsigned char across_yv = mesh.neighbors[t][1];
+      const unsigned char corner_y = mesh.corners[t][2];
+      mesh.corners[t][2] = mesh.corners[u][0];
+      mesh.neighbors[t][0] = across_xo;
+      mesh.neighbors[t][1] = u;
+      mesh.corners[u][2] = corner_y;
+      mesh.corners[u][1] = mesh.corners[t][2];
+      mesh.corners[u][0] = mesh.corners[t][0];
+      mesh.neighbors[u][0] = across_oy;
+      mesh.neighbors[u][1] = across_yv;
+      mesh.neighbors[u][2] = t;
+      Relink(mesh, across_xo, u, t);
+      Relink(mesh, across_yv, t, u);
+      for (const unsigned char flipped : { t, u }) {
+        if (!queued[flipped]) {
+          stack[stack_size++] = flipped;
+          queued[flipped] = true;
+        }
+      }
+      break;
+    }
+  }
+}
+
+} // namespace
+
+bool TriangulateSmallPolygon(const Point* const* polyline, size_t size,
+                             SmallTriangulation& result)
+{
+  if (size < 3 || size > kSmallPolygonMaxPoints) {
+    return false;
+  }
+  double area = 0;
+  for (size_t i = 0; i < size; i++) {
+    const Point& point = *polyline[i];
+    for (size_t j = i + 1; j < size; j++) {
+      if (point == *polyline[j]) {
+        return false;
+      }
+    }
+    const Point& next = *polyline[i < size - 1 ? i + 1 : 0];
+    area += (point.x - next.x) * (point.y + next.y);
+  }
+  if (std::fpclassify(area) == FP_ZERO) {
+    return false;
+  }
+  // Ear clipping would cut overlapping triangles out of a self-intersecting polyline. Only edges
+  // with overlapping bounding boxes need the orientation tests.
+  Scalar min_x[kSmallPolygonMaxPoints], max_x[kSmallPolygonMaxPoints];
+  Scalar min_y[kSmallPolygonMaxPoints], max_y[kSmallPolygonMaxPoints];
+  for (size_t i = 0; i < size; i++) {
+    const Point& a = *polyline[i];
+    const Point& b = *polyline[i < size - 1 ? i + 1 : 0];
+    min_x[i] = std::min(a.x, b.x);
+    max_x[i] = std::max(a.x, b.x);
+    min_y[i] = std::min(a.y, b.y);
+    max_y[i] = std::max(a.y, b.y);
+  }
+  for (size_t i = 0; i < size; i++) {
+    for (size_t j = i + 1; j < size; j++) {
+      if (min_x[j] > max_x[i] || max_x[j] < min_x[i] || min_y[j] > max_y[i] ||
+          max_y[j] < min_y[i]) {
+        continue;
+      }
+      if (SegmentsIntersect(*polyline[i], *polyline[i < size - 1 ? i + 1 : 0], *polyline[j],
+                            *polyline[j < size - 1 ? j + 1 : 0])) {
+        return false;
+      }
+    }
+  }
+
+  // Linked list of the vertices that haven't been cut off yet, in counter-clockwise order.
+  // owner[v] is the triangle already cut off across the edge from v to next[v].
+  const bool ccw = area > 0;
+  unsigned char prev[kSmallPolygonMaxPoints];
+  unsigned char next[kSmallPolygonMaxPoints];
+  unsigned char owner[kSmallPolygonMaxPoints];
+  unsigned char owner_slot[kSmallPolygonMaxPoints];
+  for (size_t i = 0; i < size; i++) {
+    const unsigned char before = static_cast<unsigned char>(i > 0 ? i - 1 : size - 1);
+    const unsigned char after = static_cast<unsigned char>(i < size - 1 ? i + 1 : 0);
+    prev[i] = ccw ? before : after;
+    next[i] = ccw ? after : before;
+    owner[i] = kNone;
+    owner_slot[i] = 0;
+  }
+
+  Mesh mesh;
+  mesh.size = 0;
+  size_t remaining = size;
+  size_t misses = 0;
+  unsigned char v = 0;
+  while (remaining > 3) {
+    if (!IsEar(polyline, prev, next, v)) {
+      if (++misses > remaining) {
+        return false;
+      }
+      v = next[v];
+      continue;
+    }
+    // Cut off (a, v, c), the new edge from a to c is opposite of v
+    const unsigned char a = prev[v];
+    const unsigned char c = next[v];
+    const unsigned char t = static_cast<unsigned char>(mesh.size++);
+    mesh.corners[t][0] = a;
+    mesh.corners[t][1] = v;
+    mesh.corners[t][2] = c;
+    Link(mesh, t, 0, owner[v], owner_slot[v]);
+    mesh.neighbors[t][1] = kNone;
+    Link(mesh, t, 2, owner[a], owner_slot[a]);
+    owner[a] = t;
+    owner_slot[a] = 1;
+    next[a] = c;
+    prev[c] = a;
+    remaining--;
+    misses = 0;
+    v = a;
+  }
+  {
+    const unsigned char a = v;
+    const unsigned char b = next[a];
+    const unsigned char c = next[b];
+    if (Orient2d(*polyline[a], *polyline[b], *polyline[c]) != CCW) {
+      return false;
+    }
+    const unsigned char t = static_cast<unsigned char>(mesh.size++);
+    mesh.corners[t][0] = a;
+    mesh.corners[t][1] = b;
+    mesh.corners[t][2] = c;
+    Link(mesh, t, 0, owner[b], owner_slot[b]);
+    Link(mesh, t, 1, owner[c], owner_slot[c]);
+    Link(mesh, t, 2, owner[a], owner_slot[a]);
+  }
+
+  Legalize(polyline, mesh);
+
+  for (size_t t = 0; t < mesh.size; t++) {
+    int lowest = 0;
+    for (int j = 1; j < 3; j++) {
+      if (cmp(polyline[mesh.corners[t][j]], polyline[mesh.corners[t][lowest]])) {
+        lowest = j;
+      }
+    }
+    for (int j = 0; j < 3; j++) {
+      const int corner = (lowest + j) % 3;
+      result.triangles[t][j] = mesh.corners[t][corner];
+      result.constrained_edge[t][j] = mesh.neighbors[t][corner] == kNone;
+    }
+  }
+  result.size = mesh.size;
+  return true;
+}
+
+}
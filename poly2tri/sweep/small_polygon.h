@@ -0,0 +1,71 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+
+#include <cstddef>
+
+namespace p2t {
+
+/// Largest polyline TriangulateSmallPolygon accepts
+const size_t kSmallPolygonMaxPoints = 16;
+
+/**
+ * Fixed-capacity output of TriangulateSmallPolygon, fits on the stack
+ */
+struct P2T_DLL_SYMBOL SmallTriangulation {
+  /// Counter-clockwise indices into the polyline, starting with the lowest point like the
+  /// triangles of CDT::GetTriangles
+  unsigned char triangles[kSmallPolygonMaxPoints - 2][3];
+  /// Whether the edge opposite triangles[i][j] is part of the polyline
+  bool constrained_edge[kSmallPolygonMaxPoints - 2][3];
+  /// Number of triangles, always the number of points minus two
+  size_t size;
+};
+
+/**
+ * Constrained Delaunay triangulation of a small simple polygon without holes. Gives the same
+ * triangles as CDT, but without any heap allocations: the polygon is cut into ears and
+ * flipped on fixed-size arrays.
+ *
+ * @param polyline - at most kSmallPolygonMaxPoints points, clockwise or counter-clockwise
+ * @param size - number of points
+ * @param result
+ * @return false if the polyline is too large, has repeat points, intersects itself or no ears
+ *         could be found, CDT has to be used in that case
+ */
+P2T_DLL_SYMBOL bool TriangulateSmallPolygon(const Point* const* polyline, size_t size,
+                                            SmallTriangulation& result);
+
+}
@@ -33,25 +33,100 @@
 #include "advancing_front.h"
 #include "../common/utils.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <random>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace p2t {
 
+namespace {
+
+/// Whether the points aren't all on one line
+bool HasArea(const std::vector<Point*>& points)
+{
+  size_t second = 1;
+  while (second < points.size() && *points[second] == *points[0]) {
+    second++;
+  }
+  for (size_t i = second + 1; i < points.size(); i++) {
+    if (Orient2d(*points[0], *points[second], *points[i]) != COLLINEAR) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef P2T_INTEGER_COORDINATES
+void CheckIntegerCoordinates(const Point& point, const char* where)
+{
+  if (!IsIntegerCoordinate(point.x) || !IsIntegerCoordinate(point.y)) {
+    throw std::runtime_error(std::string(where) +
+                             " - coordinates must be integers of magnitude at most 2^28");
+  }
+}
+#endif
+
+} // namespace
+
 // Triangulate simple polygon with holes
-void Sweep::Triangulate(SweepContext& tcx)
+void Sweep::Triangulate(SweepContext& tcx, TriangleVisitor* visitor)
 {
-  tcx.InitTriangulation();
-  tcx.CreateAdvancingFront();
-  // Sweep points; build mesh
-  SweepPoints(tcx);
-  // Clean up
-  FinalizationPolygon(tcx);
+  if (visitor) {
+    // Has to happen before the points get welded or sorted
+    tcx.IndexPoints();
+  }
+#ifdef P2T_INTEGER_COORDINATES
+  for (const Point* point : tcx.points_) {
+    CheckIntegerCoordinates(*point, "Sweep::Triangulate");
+  }
+#endif
+  bool changed = false;
+  if (tcx.weld_tolerance() >= 0) {
+    changed = tcx.WeldPoints();
+    SampleMemoryUsage(tcx, tcx.scratch_memory_usage());
+  }
+  if (tcx.split_intersections()) {
+    changed = tcx.SplitIntersections() || changed;
+    SampleMemoryUsage(tcx, tcx.scratch_memory_usage());
+  }
+  if (!changed && tcx.monotone_fast_path() && TriangulateMonotone(tcx, visitor)) {
+    return;
+  }
+  if (tcx.point_cloud() && !HasArea(tcx.points_)) {
+    // Nothing to triangulate
+    SampleMemoryUsage(tcx, 0);
+    return;
+  }
+  // Polygons far apart get a front each. A front across all of them would be walked from one to
+  // the next for every point, and triangulate the gaps between them.
+  const std::vector<size_t> clusters = tcx.polyline_count() > 1 && !changed
+                                           ? tcx.ClusterPoints()
+                                           : std::vector<size_t>{ 0, tcx.point_count() };
+  for (size_t i = 0; i + 1 < clusters.size(); i++) {
+    const size_t first_triangle = tcx.map_.size();
+    tcx.InitTriangulation(clusters[i], clusters[i + 1]);
+    tcx.CreateAdvancingFront(clusters[i]);
+    // Sweep points; build mesh
+    SweepPoints(tcx, clusters[i], clusters[i + 1]);
+    // Clean up
+    if (tcx.point_cloud()) {
+      FinalizationPointCloud(tcx, visitor);
+    } else {
+      FinalizationPolygon(tcx, visitor, first_triangle);
+    }
+  }
+  SampleMemoryUsage(tcx, 0);
 }
 
-void Sweep::SweepPoints(SweepContext& tcx)
+void Sweep::SweepPoints(SweepContext& tcx, size_t first, size_t last)
 {
-  for (size_t i = 1; i < tcx.point_count(); i++) {
+  for (size_t i = first + 1; i < last; i++) {
     Point& point = *tcx.GetPoint(i);
     Node* node = &PointEvent(tcx, point);
     for (auto& j : point.edge_list) {
@@ -60,8 +135,20 @@ void Sweep::SweepPoints(SweepContext& tcx)
   }
 }
 
-void Sweep::FinalizationPolygon(SweepContext& tcx)
+void Sweep::FinalizationPolygon(SweepContext& tcx, TriangleVisitor* visitor, size_t first)
 {
+  if (tcx.polyline_count() > 1 || tcx.split_intersections()) {
+    // The polygons, or the parts of a polygon crossing itself, aren't connected. Start from
+    // outside of all of them.
+    for (size_t i = first; i < tcx.map_.size(); i++) {
+      Triangle* t = tcx.map_[i];
+      if (t->Contains(tcx.head()) || t->Contains(tcx.tail())) {
+        tcx.MeshCleanComponents(*t, visitor);
+        return;
+      }
+    }
+  }
+
   // Get an Internal triangle to start with
   Triangle* t = tcx.front()->head()->next->triangle;
   Point* p = tcx.front()->head()->next->point;
@@ -71,7 +158,1284 @@ void Sweep::FinalizationPolygon(SweepContext& tcx)
 
   // Collect interior triangles constrained by edges
   if (t) {
-    tcx.MeshClean(*t);
+    tcx.MeshClean(*t, visitor);
+  }
+}
+
+void Sweep::FinalizationPointCloud(SweepContext& tcx, TriangleVisitor* visitor)
+{
+  const Point* head = tcx.head();
+  const Point* tail = tcx.tail();
+  const auto is_real = [head, tail](Triangle* t) {
+    return !t->Contains(head) && !t->Contains(tail);
+  };
+
+  // Fill the concave parts of the front, it is the upper convex hull afterwards
+  Node* node = tcx.front()->head()->next;
+  while (node->next) {
+    if (Orient2d(*node->prev->point, *node->point, *node->next->point) == CCW) {
+      Node* prev = node->prev;
+      Fill(tcx, *node);
+      node = prev->prev ? prev : prev->next;
+    } else {
+      node = node->next;
+    }
+  }
+
+  // Below the front the points are connected to the artificial head and tail points, which
+  // lie outside of the convex hull
+  std::vector<Triangle*> outside;
+  std::vector<std::pair<Point*, Triangle*>> work;
+  for (Triangle* t : tcx.map_) {
+    if (!is_real(t)) {
+      outside.push_back(t);
+      for (int i = 0; i < 3; i++) {
+        Point* point = t->GetPoint(i);
+        if (point != head && point != tail) {
+          work.emplace_back(point, t);
+        }
+      }
+    }
+  }
+  // Flip the edges to the artificial points away where the points don't form the hull yet
+  while (!work.empty()) {
+    Point* point = work.back().first;
+    Triangle* t = work.back().second;
+    work.pop_back();
+    if (t->Contains(point)) {
+      if (Triangle* closed = CloseHullAt(tcx, *point, *t, work)) {
+        work.emplace_back(point, closed);
+      }
+    }
+  }
+
+  // Mark the hull like the border of a polygon: against the triangles still outside and along
+  // the front
+  Triangle* inside = nullptr;
+  Triangle* outer = nullptr;
+  for (Triangle* t : outside) {
+    if (!is_real(t)) {
+      outer = t;
+      for (int i = 0; i < 3; i++) {
+        Triangle* neighbor = t->GetNeighbor(i);
+        if (neighbor && is_real(neighbor)) {
+          t->constrained_edge[i] = true;
+          neighbor->MarkConstrainedEdge(t->PointCCW(*t->GetPoint(i)),
+                                        t->PointCW(*t->GetPoint(i)));
+          inside = neighbor;
+        }
+      }
+    }
+  }
+  for (node = tcx.front()->head()->next; node->next->next; node = node->next) {
+    node->triangle->MarkConstrainedEdge(node->point, node->next->point);
+  }
+
+  // Neither the flips nor the sweep with its stale delaunay_edge marks guarantee the Delaunay
+  // property inside. Test every edge once, from the triangle at the lower address, then flip
+  // from the illegal ones until every edge is locally Delaunay. The hull is constrained now.
+  std::vector<Triangle*> illegal;
+  for (Triangle* t : tcx.map_) {
+    for (int i = 0; i < 3; i++) {
+      Triangle* ot = t->GetNeighbor(i);
+      if (!ot || t->constrained_edge[i] || !std::less<Triangle*>()(t, ot) || !is_real(t)) {
+        continue;
+      }
+      Point* p = t->GetPoint(i);
+      if (Incircle(*p, *t->PointCCW(*p), *t->PointCW(*p), *ot->OppositePoint(*t, *p))) {
+        illegal.push_back(t);
+        break;
+      }
+    }
+  }
+  LegalizeTriangles(illegal);
+  if (tcx.has_rings()) {
+    if (!outer) {
+      // The artificial points always keep some triangles, unless the mesh is broken
+      throw std::runtime_error("FinalizationPointCloud - no triangle outside of the hull");
+    }
+    tcx.LabelRegions(*outer, visitor);
+  } else if (inside) {
+    tcx.MeshClean(*inside, visitor);
+  }
+}
+
+Triangle* Sweep::CloseHullAt(SweepContext& tcx, Point& point, Triangle& triangle,
+                             std::vector<std::pair<Point*, Triangle*>>& work)
+{
+  const auto is_artificial = [&tcx](const Point* p) { return p == tcx.head() || p == tcx.tail(); };
+
+  // Triangles around the point in counterclockwise order, triangle i between ring[i] and
+  // ring[i + 1]. Open stars start at the border.
+  Triangle* start = &triangle;
+  bool closed = false;
+  while (Triangle* previous = start->NeighborCCW(point)) {
+    if (previous == &triangle) {
+      closed = true;
+      break;
+    }
+    start = previous;
+  }
+  std::vector<Triangle*> star;
+  std::vector<Point*> ring{ start->PointCCW(point) };
+  for (Triangle* t = start; t && (star.empty() || t != start); t = t->NeighborCW(point)) {
+    star.push_back(t);
+    ring.push_back(t->PointCW(point));
+  }
+  if (closed) {
+    // Start at a real neighbor, there are at most two artificial ones
+    const size_t first = is_artificial(ring[0]) ? (is_artificial(ring[1]) ? 2 : 1) : 0;
+    std::rotate(star.begin(), star.begin() + first, star.end());
+    ring.pop_back();
+    std::rotate(ring.begin(), ring.begin() + first, ring.end());
+    ring.push_back(ring[0]);
+  }
+
+  for (size_t a = 0; a + 2 < ring.size(); a++) {
+    size_t c = a + 1;
+    while (c < ring.size() && is_artificial(ring[c])) {
+      c++;
+    }
+    if (is_artificial(ring[a]) || c == a + 1 || c == ring.size() ||
+        Orient2d(point, *ring[a], *ring[c]) != CCW) {
+      continue;
+    }
+    // An ear: the neighbor is on the other side of the line between its neighbors
+    while (c > a + 1) {
+      size_t i = a + 1;
+      while (i < c && Orient2d(*ring[i - 1], *ring[i + 1], *ring[i]) != CW) {
+        i++;
+      }
+      if (i == c) {
+        // Can't happen as the artificial points are outside of the convex hull
+        return nullptr;
+      }
+      Triangle* t = star[i - 1];
+      Triangle* ot = star[i];
+      RotateTrianglePair(*t, *ring[i - 1], *ot, *ring[i + 1]);
+      if (!t->Contains(&point)) {
+        std::swap(t, ot);
+      }
+      star[i - 1] = t;
+      star.erase(star.begin() + i);
+      ring.erase(ring.begin() + i);
+      c--;
+      for (Point* neighbor : { ring[i - 1], ring[i] }) {
+        if (!is_artificial(neighbor)) {
+          work.emplace_back(neighbor, t);
+        }
+      }
+    }
+    return star[a];
+  }
+  return nullptr;
+}
+
+namespace {
+
+/**
+ * Collect the constrained sides of a group of adjacent triangles that are about to be
+ * replaced, and the triangles around them
+ */
+void CollectCavity(const std::vector<Triangle*>& cavity,
+                   std::vector<std::pair<Point*, Point*>>& constrained,
+                   std::vector<Triangle*>& around)
+{
+  for (Triangle* t : cavity) {
+    for (int i = 0; i < 3; i++) {
+      if (t->constrained_edge[i]) {
+        constrained.emplace_back(t->GetPoint((i + 1) % 3), t->GetPoint((i + 2) % 3));
+      }
+      Triangle* neighbor = t->GetNeighbor(i);
+      if (neighbor && std::find(cavity.begin(), cavity.end(), neighbor) == cavity.end()) {
+        around.push_back(neighbor);
+      }
+    }
+  }
+}
+
+/// Link the triangles that filled a cavity to each other and to the triangles around it
+void LinkCavity(const std::vector<Triangle*>& created, const std::vector<Triangle*>& around)
+{
+  for (size_t i = 0; i < created.size(); i++) {
+    for (size_t j = i + 1; j < created.size(); j++) {
+      created[i]->MarkNeighbor(*created[j]);
+    }
+    for (Triangle* neighbor : around) {
+      created[i]->MarkNeighbor(*neighbor);
+    }
+  }
+}
+
+/// Whether there is an edge from p to q, t is a triangle with p as vertex
+bool HasEdge(Triangle* t, Point& p, const Point& q)
+{
+  // Turn around p both ways, in case it is on the border
+  for (Triangle* u = t; u;) {
+    if (u->Contains(&q)) {
+      return true;
+    }
+    u = u->NeighborCW(p);
+    if (u == t) {
+      return false;
+    }
+  }
+  for (Triangle* u = t->NeighborCCW(p); u; u = u->NeighborCCW(p)) {
+    if (u->Contains(&q)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Whether the edges without a neighbor, which bound the triangulation, intersect each other
+bool BorderIntersects(const std::vector<Triangle*>& triangles)
+{
+  struct Segment {
+    const Point* a;
+    const Point* b;
+    Scalar min_x;
+    Scalar max_x;
+  };
+  std::vector<Segment> border;
+  for (Triangle* t : triangles) {
+    for (int i = 0; i < 3; i++) {
+      if (!t->GetNeighbor(i)) {
+        const Point* a = t->GetPoint((i + 1) % 3);
+        const Point* b = t->GetPoint((i + 2) % 3);
+        border.push_back({ a, b, std::min(a->x, b->x), std::max(a->x, b->x) });
+      }
+    }
+  }
+  // Only segments overlapping in x need to be compared
+  std::sort(border.begin(), border.end(),
+            [](const Segment& lhs, const Segment& rhs) { return lhs.min_x < rhs.min_x; });
+  for (size_t i = 0; i < border.size(); i++) {
+    for (size_t j = i + 1; j < border.size() && border[j].min_x <= border[i].max_x; j++) {
+      if (SegmentsIntersect(*border[i].a, *border[i].b, *border[j].a, *border[j].b)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Constrained Delaunay triangulation of the pseudo-polygon a, b, chain[lo], ..., chain[hi - 1]
+ * (counter-clockwise) that is left when the segment from a to b is forced into a mesh
+ */
+void TriangulatePseudoPolygon(Point* a, Point* b, const std::vector<Point*>& chain, size_t lo,
+                              size_t hi, std::vector<Point*>& triangles)
+{
+  if (lo == hi) {
+    return;
+  }
+  // The vertex whose circumcircle with a and b contains no other vertex of the chain
+  size_t c = lo;
+  for (size_t i = lo + 1; i < hi; i++) {
+    if (InCircumcircle(*a, *b, *chain[c], *chain[i])) {
+      c = i;
+    }
+  }
+  triangles.push_back(a);
+  triangles.push_back(b);
+  triangles.push_back(chain[c]);
+  TriangulatePseudoPolygon(chain[c], b, chain, lo, c, triangles);
+  TriangulatePseudoPolygon(a, chain[c], chain, c + 1, hi, triangles);
+}
+
+} // namespace
+
+bool Sweep::TriangulateMonotone(SweepContext& tcx, TriangleVisitor* visitor)
+{
+  const size_t n = tcx.point_count();
+  if (n < 3 || n != tcx.polyline_size()) {
+    // Holes or Steiner points
+    return false;
+  }
+  const std::vector<Point*>& polygon = tcx.points_;
+
+  // A polygon is y-monotone if it has exactly one local minimum in sweep order
+  size_t bottom = 0, top = 0, minima = 0, left_turns = 0, right_turns = 0;
+  double area = 0;
+  for (size_t i = 0; i < n; i++) {
+    const Point* prev = polygon[i > 0 ? i - 1 : n - 1];
+    const Point* point = polygon[i];
+    const Point* next = polygon[i < n - 1 ? i + 1 : 0];
+    if (*point == *next) {
+      // Repeat points, let the sweep report them
+      return false;
+    }
+    const bool prev_below = cmp(prev, point);
+    const bool next_below = cmp(next, point);
+    if (!prev_below && !next_below) {
+      minima++;
+      bottom = i;
+    } else if (prev_below && next_below) {
+      top = i;
+    }
+    area += (point->x - next->x) * (point->y + next->y);
+    const Orientation turn = Orient2d(*prev, *point, *next);
+    if (turn == CCW) {
+      left_turns++;
+    } else if (turn == CW) {
+      right_turns++;
+    }
+  }
+  if (minima != 1 || std::fpclassify(area) == FP_ZERO) {
+    return false;
+  }
+
+  const bool ccw = area > 0;
+  std::vector<size_t> triangles;
+  triangles.reserve(3 * (n - 2));
+  const bool convex = (ccw ? left_turns : right_turns) == n;
+  if (convex) {
+    std::vector<size_t> ring(n);
+    for (size_t i = 0; i < n; i++) {
+      ring[i] = ccw ? i : n - 1 - i;
+    }
+    TriangulateConvex(polygon, ring, triangles);
+  } else if (!TriangulateMonotoneChains(polygon, bottom, top, ccw, triangles)) {
+    return false;
+  }
+  // Start with the lowest point so the result doesn't depend on how the polygon was walked
+  for (size_t i = 0; i < triangles.size(); i += 3) {
+    while (cmp(polygon[triangles[i + 1]], polygon[triangles[i]]) ||
+           cmp(polygon[triangles[i + 2]], polygon[triangles[i]])) {
+      std::swap(triangles[i], triangles[i + 1]);
+      std::swap(triangles[i + 1], triangles[i + 2]);
+    }
+  }
+
+  // Create the triangles and link neighbors through the triangles incident to each vertex
+  std::vector<Triangle*> created;
+  created.reserve(n - 2);
+  std::vector<size_t> first_incident(n + 1, 0);
+  for (size_t index : triangles) {
+    first_incident[index + 1]++;
+  }
+  for (size_t i = 0; i < n; i++) {
+    first_incident[i + 1] += first_incident[i];
+  }
+  std::vector<size_t> fill(first_incident.begin(), first_incident.end() - 1);
+  std::vector<Triangle*> incident(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i += 3) {
+    Triangle* t = new Triangle(*polygon[triangles[i]], *polygon[triangles[i + 1]],
+                               *polygon[triangles[i + 2]]);
+    tcx.AddToMap(t);
+    created.push_back(t);
+    for (size_t j = i; j < i + 3; j++) {
+      incident[fill[triangles[j]]++] = t;
+    }
+  }
+  for (size_t i = 0; i < created.size(); i++) {
+    Triangle* t = created[i];
+    for (int j = 0; j < 3; j++) {
+      const size_t a = triangles[3 * i + (j + 1) % 3];
+      const size_t b = triangles[3 * i + (j + 2) % 3];
+      if (a + 1 == b || b + 1 == a || (a == 0 && b == n - 1) || (b == 0 && a == n - 1)) {
+        // Edge of the polyline
+        t->MarkConstrainedEdge(j);
+      } else if (!t->GetNeighbor(j)) {
+        for (size_t k = first_incident[a]; k < first_incident[a + 1]; k++) {
+          if (incident[k] != t && incident[k]->Contains(polygon[b])) {
+            t->MarkNeighbor(*incident[k]);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  if (!convex) {
+    LegalizeTriangles(created);
+  }
+  tcx.MeshClean(*tcx.map_.front(), visitor);
+  SampleMemoryUsage(tcx, triangles.capacity() * sizeof(size_t) +
+                             created.capacity() * sizeof(Triangle*) +
+                             (first_incident.capacity() + fill.capacity()) * sizeof(size_t) +
+                             incident.capacity() * sizeof(Triangle*));
+  return true;
+}
+
+bool Sweep::TriangulateMonotoneChains(const std::vector<Point*>& polygon, size_t bottom,
+                                      size_t top, bool ccw, std::vector<size_t>& triangles) const
+{
+  const size_t n = polygon.size();
+
+  // Merge the two chains into sweep order. Walking forward from the bottom goes up the
+  // right chain if the polygon is counter-clockwise.
+  std::vector<std::pair<size_t, bool>> order;
+  order.reserve(n);
+  order.emplace_back(bottom, false);
+  size_t forward = bottom < n - 1 ? bottom + 1 : 0;
+  size_t backward = bottom > 0 ? bottom - 1 : n - 1;
+  while (forward != top || backward != top) {
+    if (backward == top || (forward != top && cmp(polygon[forward], polygon[backward]))) {
+      order.emplace_back(forward, ccw);
+      forward = forward < n - 1 ? forward + 1 : 0;
+    } else {
+      order.emplace_back(backward, !ccw);
+      backward = backward > 0 ? backward - 1 : n - 1;
+    }
+  }
+  order.emplace_back(top, false);
+
+  // Triangulate the chains with a stack of vertices still waiting for a triangle. A triangle
+  // from a vertex on the right chain to two vertices of the left one is clockwise and vice
+  // versa. Any other orientation means the chains cross each other.
+  auto add_triangle = [&](size_t a, size_t b, size_t c, bool right) {
+    const Orientation o = Orient2d(*polygon[a], *polygon[b], *polygon[c]);
+    if (o != (right ? CW : CCW)) {
+      return false;
+    }
+    if (o == CW) {
+      std::swap(b, c);
+    }
+    triangles.push_back(a);
+    triangles.push_back(b);
+    triangles.push_back(c);
+    return true;
+  };
+  std::vector<std::pair<size_t, bool>> stack{ order[0], order[1] };
+  for (size_t j = 2; j < n - 1; j++) {
+    const size_t u = order[j].first;
+    const bool right = order[j].second;
+    if (right != stack.back().second) {
+      // Opposite chain: everything on the stack is visible from u
+      for (size_t k = 0; k + 1 < stack.size(); k++) {
+        if (!add_triangle(u, stack[k].first, stack[k + 1].first, right)) {
+          return false;
+        }
+      }
+      const auto last = stack.back();
+      stack.clear();
+      stack.push_back(last);
+    } else {
+      // Same chain: cut off vertices as long as the diagonal stays inside
+      auto last = stack.back();
+      stack.pop_back();
+      while (!stack.empty()) {
+        const Orientation o = Orient2d(*polygon[stack.back().first], *polygon[u],
+                                       *polygon[last.first]);
+        if (o != (right ? CW : CCW)) {
+          break;
+        }
+        if (!add_triangle(u, last.first, stack.back().first, right)) {
+          return false;
+        }
+        last = stack.back();
+        stack.pop_back();
+      }
+      stack.push_back(last);
+    }
+    stack.push_back(order[j]);
+  }
+  // The top closes the chain opposite to the one on the stack
+  for (size_t k = 0; k + 1 < stack.size(); k++) {
+    if (!add_triangle(order[n - 1].first, stack[k].first, stack[k + 1].first,
+                      !stack.back().second)) {
+      return false;
+    }
+  }
+  return triangles.size() == 3 * (n - 2);
+}
+
+void Sweep::TriangulateConvex(const std::vector<Point*>& polygon,
+                              const std::vector<size_t>& ring,
+                              std::vector<size_t>& triangles) const
+{
+  const size_t n = ring.size();
+
+  // Remove the vertices in random order, remembering their neighbors at that time. The
+  // generator is seeded with a constant so that the output is reproducible.
+  std::vector<size_t> prev(n), next(n);
+  for (size_t i = 0; i < n; i++) {
+    prev[i] = i > 0 ? i - 1 : n - 1;
+    next[i] = i < n - 1 ? i + 1 : 0;
+  }
+  std::vector<size_t> removal(n);
+  for (size_t i = 0; i < n; i++) {
+    removal[i] = i;
+  }
+  std::minstd_rand random;
+  for (size_t i = n - 1; i > 0; i--) {
+    std::swap(removal[i], removal[random() % (i + 1)]);
+  }
+  std::vector<std::pair<size_t, size_t>> removed_between(n);
+  for (size_t i = 0; i + 3 < n; i++) {
+    const size_t v = removal[i];
+    removed_between[v] = std::make_pair(prev[v], next[v]);
+    next[prev[v]] = next[v];
+    prev[next[v]] = prev[v];
+  }
+
+  // Triangles are index triples into ring, neighbors[3 * t + j] is across the edge opposite
+  // vertex j and hull[v] is the triangle with the boundary edge from v to its successor.
+  const size_t none = static_cast<size_t>(-1);
+  std::vector<size_t> corners, neighbors;
+  corners.reserve(3 * (n - 2));
+  neighbors.reserve(3 * (n - 2));
+  std::vector<size_t> hull(n, none);
+  {
+    const size_t a = removal[n - 1];
+    corners.insert(corners.end(), { a, next[a], next[next[a]] });
+    neighbors.insert(neighbors.end(), { none, none, none });
+    hull[a] = hull[next[a]] = hull[next[next[a]]] = 0;
+  }
+  const auto point = [&](size_t triangle, int j) -> const Point& {
+    return *polygon[ring[corners[3 * triangle + j]]];
+  };
+  // Replace the link from triangle `from` to `old_neighbor` with `new_neighbor`
+  const auto relink = [&](size_t from, size_t old_neighbor, size_t new_neighbor) {
+    if (from == none) {
+      return;
+    }
+    for (int j = 0; j < 3; j++) {
+      if (neighbors[3 * from + j] == old_neighbor) {
+        neighbors[3 * from + j] = new_neighbor;
+      }
+    }
+  };
+
+  std::vector<size_t> pending;
+  for (size_t i = n - 3; i-- > 0;) {
+    // Put v back outside of the boundary edge (q, r) and flip until Delaunay again
+    const size_t v = removal[i];
+    const size_t q = removed_between[v].first;
+    const size_t r = removed_between[v].second;
+    const size_t outer = hull[q];
+    const size_t t = corners.size() / 3;
+    corners.insert(corners.end(), { v, r, q });
+    neighbors.insert(neighbors.end(), { outer, none, none });
+    for (int j = 0; j < 3; j++) {
+      if (corners[3 * outer + j] != q && corners[3 * outer + j] != r) {
+        neighbors[3 * outer + j] = t;
+      }
+    }
+    hull[q] = hull[v] = t;
+
+    // Triangles in pending have v as their first corner, the edge to check is opposite of it
+    pending.push_back(t);
+    while (!pending.empty()) {
+      const size_t a = pending.back();
+      pending.pop_back();
+      const size_t b = neighbors[3 * a];
+      if (b == none) {
+        continue;
+      }
+      int k = 0;
+      while (neighbors[3 * b + k] != a) {
+        k++;
+      }
+      // a = (v, x, y), b = (o, y, x) once rotated to start at its opposite corner o
+      const size_t x = corners[3 * a + 1];
+      const size_t y = corners[3 * a + 2];
+      const size_t o = corners[3 * b + k];
+      const size_t across_xo = neighbors[3 * b + (k + 1) % 3];
+      const size_t across_oy = neighbors[3 * b + (k + 2) % 3];
+      if (!Incircle(point(a, 0), point(a, 1), point(a, 2), point(b, k))) {
+        continue;
+      }
+      // Flip to a = (v, x, o) and b = (v, o, y)
+      const size_t across_yv = neighbors[3 * a + 1];
+      corners[3 * a + 2] = o;
+      neighbors[3 * a] = across_xo;
+      neighbors[3 * a + 1] = b;
+      corners[3 * b] = v;
+      corners[3 * b + 1] = o;
+      corners[3 * b + 2] = y;
+      neighbors[3 * b] = across_oy;
+      neighbors[3 * b + 1] = across_yv;
+      neighbors[3 * b + 2] = a;
+      relink(across_xo, b, a);
+      relink(across_yv, a, b);
+      if (across_xo == none) {
+        hull[x] = a;
+      }
+      if (across_yv == none) {
+        hull[y] = b;
+      }
+      pending.push_back(a);
+      pending.push_back(b);
+    }
+  }
+
+  for (size_t corner : corners) {
+    triangles.push_back(ring[corner]);
+  }
+}
+
+void Sweep::InsertPoint(SweepContext& tcx, Point& point)
+{
+#ifdef P2T_INTEGER_COORDINATES
+  CheckIntegerCoordinates(point, "Sweep::InsertPoint");
+#endif
+  Triangle* t = LocateInteriorTriangle(tcx, point);
+
+  int split_edge = -1;
+  for (int i = 0; i < 3; i++) {
+    if (*t->GetPoint(i) == point) {
+      throw std::runtime_error("InsertPoint - repeat point");
+    }
+    if (Orient2d(*t->GetPoint((i + 1) % 3), *t->GetPoint((i + 2) % 3), point) == COLLINEAR) {
+      split_edge = i;
+    }
+  }
+
+  // The triangles being replaced, with the constrained edges and neighbors around them
+  std::vector<Triangle*> old_triangles{ t };
+  if (split_edge >= 0 && t->GetNeighbor(split_edge)) {
+    old_triangles.push_back(t->GetNeighbor(split_edge));
+  }
+  std::vector<std::pair<Point*, Point*>> constrained;
+  std::vector<Triangle*> around;
+  CollectCavity(old_triangles, constrained, around);
+  if (split_edge >= 0 && t->constrained_edge[split_edge]) {
+    constrained.emplace_back(t->GetPoint((split_edge + 1) % 3), &point);
+    constrained.emplace_back(&point, t->GetPoint((split_edge + 2) % 3));
+    // Sweeping again, e.g. in Retriangulate, has to see both halves as well
+    tcx.SplitEdge(t->GetPoint((split_edge + 1) % 3), t->GetPoint((split_edge + 2) % 3), point);
+  }
+
+  // Connect the point to every side except the one it lies on, reusing the old triangles
+  std::vector<Triangle*> created, interior;
+  for (Triangle* old : old_triangles) {
+    const bool is_interior = old->IsInterior();
+    Point* corners[3] = { old->GetPoint(0), old->GetPoint(1), old->GetPoint(2) };
+    bool reused = false;
+    for (int i = 0; i < 3; i++) {
+      Point& p = *corners[(i + 1) % 3];
+      Point& q = *corners[(i + 2) % 3];
+      if (Orient2d(p, q, point) == COLLINEAR) {
+        continue;
+      }
+      Triangle* triangle = old;
+      if (reused && is_interior) {
+        triangle = tcx.AddInteriorTriangle(p, q, point);
+      } else if (reused) {
+        triangle = new Triangle(p, q, point);
+        tcx.AddToMap(triangle);
+      } else {
+        tcx.ReuseTriangle(*triangle, p, q, point);
+        reused = true;
+      }
+      triangle->IsInterior(is_interior);
+      for (const auto& edge : constrained) {
+        triangle->MarkConstrainedEdge(edge.first, edge.second);
+      }
+      created.push_back(triangle);
+      if (is_interior) {
+        interior.push_back(triangle);
+      }
+    }
+  }
+  LinkCavity(created, around);
+
+  tcx.RestorePoint(&point);
+  tcx.locate_hint_ = t;
+  LegalizeTriangles(interior);
+}
+
+Triangle* Sweep::LocateInteriorTriangle(SweepContext& tcx, const Point& point)
+{
+  Triangle* t = tcx.LocateTriangle(point);
+  if (t && !t->IsInterior()) {
+    // A point on the boundary can be found from the outside
+    for (int i = 0; i < 3; i++) {
+      Triangle* neighbor = t->GetNeighbor(i);
+      if (neighbor && neighbor->IsInterior() &&
+          Orient2d(*t->GetPoint((i + 1) % 3), *t->GetPoint((i + 2) % 3), point) == COLLINEAR) {
+        t = neighbor;
+        break;
+      }
+    }
+  }
+  if (!t || !t->IsInterior()) {
+    throw std::runtime_error("InsertPoint - point outside of the triangulation");
+  }
+  return t;
+}
+
+void Sweep::InsertConstraint(SweepContext& tcx, Point& p, Point& q)
+{
+  if (p == q) {
+    throw std::runtime_error("InsertConstraint - p == q");
+  }
+  CheckSegment(tcx, p, q);
+  LocateVertex(tcx, q);
+  Point* start = &p;
+  while (start != &q) {
+    start = RecoverSegment(tcx, LocateVertex(tcx, *start), *start, q);
+  }
+}
+
+void Sweep::CheckSegment(SweepContext& tcx, Point& p, Point& q)
+{
+  // The walk is either at the vertex from or in t, which it entered through the edge opposite
+  // the corner entry
+  Point* from = nullptr;
+  Triangle* t = nullptr;
+  int entry = -1;
+
+  // Leave t through the edge opposite corner k, returns true if q comes first
+  const auto cross = [&](int k) {
+    Point* x = t->GetPoint((k + 1) % 3);
+    Point* y = t->GetPoint((k + 2) % 3);
+    if (Orient2d(*x, *y, q) != CW) {
+      return true;
+    }
+    if (t->constrained_edge[k]) {
+      throw std::runtime_error("InsertConstraint - segment crosses a constrained edge");
+    }
+    Triangle* next = t->GetNeighbor(k);
+    if (!next || !next->IsInterior()) {
+      throw std::runtime_error("InsertConstraint - segment outside of the triangulation");
+    }
+    t = next;
+    entry = t->EdgeIndex(x, y);
+    return false;
+  };
+  // Whether the segment ends before or at the vertex v lying on it
+  const auto ends_at = [&](Point& v) {
+    if (&v == &q) {
+      return true;
+    }
+    if (v == q) {
+      throw std::runtime_error("InsertConstraint - repeat point");
+    }
+    return Dot(q - p, q - p) < Dot(v - p, q - p);
+  };
+
+  t = tcx.LocateTriangle(p);
+  if (t && t->Contains(&p)) {
+    from = &p;
+  } else {
+    t = LocateInteriorTriangle(tcx, p);
+    for (int i = 0; i < 3; i++) {
+      if (*t->GetPoint(i) == p) {
+        throw std::runtime_error("InsertConstraint - repeat point");
+      }
+    }
+    // p will split the edge it lies on, start on the side of the edge q is on
+    for (int i = 0; i < 3; i++) {
+      Point& x = *t->GetPoint((i + 1) % 3);
+      Point& y = *t->GetPoint((i + 2) % 3);
+      if (Orient2d(x, y, p) != COLLINEAR) {
+        continue;
+      }
+      const Orientation o = Orient2d(x, y, q);
+      if (o == COLLINEAR) {
+        Point& end = Dot(x - p, q - p) > 0 ? x : y;
+        if (ends_at(end)) {
+          return;
+        }
+        from = &end;
+      } else if (o == CW) {
+        Triangle* next = t->GetNeighbor(i);
+        if (!next || !next->IsInterior()) {
+          throw std::runtime_error("InsertConstraint - segment outside of the triangulation");
+        }
+        t = next;
+      }
+      break;
+    }
+    if (!from) {
+      // Leave t through a vertex on the segment or through the edge it crosses
+      int exit = -1;
+      for (int i = 0; i < 3 && !from; i++) {
+        Point& v = *t->GetPoint(i);
+        if (Orient2d(p, q, v) == COLLINEAR && Dot(v - p, q - p) > 0) {
+          if (ends_at(v)) {
+            return;
+          }
+          from = &v;
+        } else if (Orient2d(p, q, *t->GetPoint((i + 1) % 3)) == CW &&
+                   Orient2d(p, q, *t->GetPoint((i + 2) % 3)) == CCW) {
+          exit = i;
+        }
+      }
+      if (!from) {
+        if (exit < 0) {
+          throw std::runtime_error("InsertConstraint - no way out of the triangle around p");
+        }
+        if (cross(exit)) {
+          return;
+        }
+      }
+    }
+  }
+
+  for (;;) {
+    if (from) {
+      Point* along = nullptr;
+      t = FindSegmentStart(t, *from, q, along);
+      if (along) {
+        Triangle* other = t->GetNeighbor(t->EdgeIndex(from, along));
+        if (!t->IsInterior() && !(other && other->IsInterior())) {
+          throw std::runtime_error("InsertConstraint - segment outside of the triangulation");
+        }
+        if (ends_at(*along)) {
+          return;
+        }
+        from = along;
+        continue;
+      }
+      if (!t->IsInterior()) {
+        throw std::runtime_error("InsertConstraint - segment outside of the triangulation");
+      }
+      const int k = t->Index(from);
+      from = nullptr;
+      if (cross(k)) {
+        return;
+      }
+    }
+    // The segment passes the corner opposite the entry edge on one side or runs through it
+    Point& v = *t->GetPoint(entry);
+    const Orientation o = Orient2d(p, q, v);
+    if (o == COLLINEAR) {
+      if (ends_at(v)) {
+        return;
+      }
+      from = &v;
+      continue;
+    }
+    const int next = (entry + 1) % 3;
+    if (cross(o == Orient2d(p, q, *t->GetPoint(next)) ? next : (entry + 2) % 3)) {
+      return;
+    }
+  }
+}
+
+Triangle* Sweep::LocateVertex(SweepContext& tcx, Point& point)
+{
+  Triangle* t = tcx.LocateTriangle(point);
+  if (t && t->Contains(&point)) {
+    return t;
+  }
+  for (int i = 0; t && i < 3; i++) {
+    if (*t->GetPoint(i) == point) {
+      throw std::runtime_error("LocateVertex - repeat point");
+    }
+  }
+  InsertPoint(tcx, point);
+  // Legalizing may have flipped the point out of the triangle it was inserted in
+  return tcx.LocateTriangle(point);
+}
+
+Triangle* Sweep::FindSegmentStart(Triangle* t, Point& p, Point& q, Point*& along) const
+{
+  Triangle* const first = t;
+  bool counter_clockwise = true;
+  along = nullptr;
+  for (;;) {
+    Point* a = t->PointCCW(p);
+    Point* b = t->PointCW(p);
+    const Orientation oa = Orient2d(p, *a, q);
+    const Orientation ob = Orient2d(p, *b, q);
+    if (oa == COLLINEAR && Dot(*a - p, q - p) > 0) {
+      along = a;
+      return t;
+    }
+    if (ob == COLLINEAR && Dot(*b - p, q - p) > 0) {
+      along = b;
+      return t;
+    }
+    if (oa == CCW && ob == CW) {
+      return t;
+    }
+    Triangle* next = counter_clockwise ? t->NeighborCW(p) : t->NeighborCCW(p);
+    if (next == first) {
+      throw std::runtime_error("FindSegmentStart - no triangle around p");
+    }
+    if (!next && !counter_clockwise) {
+      throw std::runtime_error("FindSegmentStart - segment outside of the triangulation");
+    }
+    if (!next) {
+      // Hit the border of the map, go the other way around
+      counter_clockwise = false;
+      next = first;
+    }
+    t = next;
+  }
+}
+
+Point* Sweep::RecoverSegment(SweepContext& tcx, Triangle* t, Point& p, Point& q)
+{
+  Point* along = nullptr;
+  t = FindSegmentStart(t, p, q, along);
+  if (along) {
+    const int index = t->EdgeIndex(&p, along);
+    Triangle* other = t->GetNeighbor(index);
+    if (!t->IsInterior() && !(other && other->IsInterior())) {
+      throw std::runtime_error("RecoverSegment - segment outside of the triangulation");
+    }
+    if (!t->constrained_edge[index]) {
+      t->MarkConstrainedEdge(index);
+      if (other) {
+        other->MarkConstrainedEdge(&p, along);
+      }
+      tcx.edge_list.push_back(new Edge(p, *along));
+    }
+    return along;
+  }
+  if (!t->IsInterior()) {
+    throw std::runtime_error("RecoverSegment - segment outside of the triangulation");
+  }
+
+  // Walk along the segment, collecting the crossed triangles and the vertices on either side
+  std::vector<Triangle*> crossed{ t };
+  std::vector<Point*> right{ t->PointCCW(p) };
+  std::vector<Point*> left{ t->PointCW(p) };
+  Point* end = nullptr;
+  while (!end) {
+    Triangle* current = crossed.back();
+    const int index = current->EdgeIndex(right.back(), left.back());
+    Triangle* next = current->GetNeighbor(index);
+    if (current->constrained_edge[index] || !next) {
+      throw std::runtime_error("RecoverSegment - segment crosses a constrained edge");
+    }
+    Point* v = next->OppositePoint(*current, *current->GetPoint(index));
+    crossed.push_back(next);
+    if (v == &q) {
+      end = v;
+      break;
+    }
+    switch (Orient2d(p, q, *v)) {
+      case CCW:
+        left.push_back(v);
+        break;
+      case CW:
+        right.push_back(v);
+        break;
+      case COLLINEAR:
+        end = v;
+        break;
+    }
+  }
+
+  // Fill both sides of the segment, reusing the crossed triangles
+  std::vector<std::pair<Point*, Point*>> constrained{ { &p, end } };
+  std::vector<Triangle*> around;
+  CollectCavity(crossed, constrained, around);
+  std::vector<Point*> corners;
+  std::reverse(left.begin(), left.end());
+  TriangulatePseudoPolygon(&p, end, left, 0, left.size(), corners);
+  TriangulatePseudoPolygon(end, &p, right, 0, right.size(), corners);
+  assert(corners.size() == 3 * crossed.size());
+  for (size_t i = 0; i < crossed.size(); i++) {
+    Triangle* triangle = crossed[i];
+    tcx.ReuseTriangle(*triangle, *corners[3 * i], *corners[3 * i + 1], *corners[3 * i + 2]);
+    triangle->IsInterior(true);
+    for (const auto& edge : constrained) {
+      triangle->MarkConstrainedEdge(edge.first, edge.second);
+    }
+  }
+  LinkCavity(crossed, around);
+  tcx.edge_list.push_back(new Edge(p, *end));
+  tcx.locate_hint_ = crossed.front();
+  return end;
+}
+
+void Sweep::RemovePoint(SweepContext& tcx, Point& point)
+{
+  Triangle* t = tcx.LocateTriangle(point);
+  if (!t || !t->Contains(&point)) {
+    throw std::runtime_error("RemovePoint - not a vertex of the triangulation");
+  }
+  std::vector<Point*> constrained_ends;
+  std::vector<Triangle*> created;
+  RemoveVertex(tcx, *t, point, &constrained_ends, created);
+  tcx.FreeRemovedTriangles();
+  LegalizeTriangles(created);
+
+  if (!constrained_ends.empty()) {
+    // The point split a constrained edge, put it back in one piece
+    Point& a = *constrained_ends[0];
+    Point& b = *constrained_ends[1];
+    tcx.RemoveEdge(&a, &point);
+    tcx.RemoveEdge(&point, &b);
+    Point* start = &a;
+    while (start != &b) {
+      start = RecoverSegment(tcx, LocateVertex(tcx, *start), *start, b);
+    }
+  }
+}
+
+void Sweep::RemoveVertex(SweepContext& tcx, Triangle& triangle, Point& point,
+                         std::vector<Point*>* constrained_ends, std::vector<Triangle*>& created)
+{
+  // The triangles around the point and their other vertices, counter-clockwise
+  std::vector<Triangle*> star;
+  std::vector<Point*> ring;
+  std::vector<Point*> ends;
+  Triangle* t = &triangle;
+  do {
+    if (!t->IsInterior()) {
+      throw std::runtime_error("RemovePoint - vertex on the border of the triangulation");
+    }
+    Point* a = t->PointCCW(point);
+    star.push_back(t);
+    ring.push_back(a);
+    if (t->constrained_edge[t->EdgeIndex(&point, a)]) {
+      ends.push_back(a);
+    }
+    t = t->NeighborCW(point);
+  } while (t && t != star.front());
+  if (!t) {
+    throw std::runtime_error("RemovePoint - vertex on the border of the triangulation");
+  }
+  if (star.size() < 3) {
+    throw std::runtime_error("RemovePoint - hole can't be triangulated");
+  }
+  if (!ends.empty() && (!constrained_ends || ends.size() != 2 ||
+                        Orient2d(*ends[0], point, *ends[1]) != COLLINEAR)) {
+    throw std::runtime_error("RemovePoint - vertex ends a constrained edge");
+  }
+
+  std::vector<std::pair<Point*, Point*>> constrained;
+  std::vector<Triangle*> around;
+  CollectCavity(star, constrained, around);
+
+  // The ring is star-shaped, so cutting off ears always works
+  const size_t n = ring.size();
+  std::vector<size_t> prev(n), next(n);
+  for (size_t i = 0; i < n; i++) {
+    prev[i] = i > 0 ? i - 1 : n - 1;
+    next[i] = i < n - 1 ? i + 1 : 0;
+  }
+  std::vector<Point*> corners;
+  size_t remaining = n;
+  size_t misses = 0;
+  for (size_t v = 0; remaining > 3;) {
+    const Point& a = *ring[prev[v]];
+    const Point& b = *ring[v];
+    const Point& c = *ring[next[v]];
+    bool ear = Orient2d(a, b, c) == CCW;
+    for (size_t w = next[next[v]]; ear && w != prev[v]; w = next[w]) {
+      const Point& other = *ring[w];
+      ear = Orient2d(a, b, other) == CW || Orient2d(b, c, other) == CW ||
+            Orient2d(c, a, other) == CW;
+    }
+    // The diagonal can already be an edge outside of the hole if the points around it moved
+    ear = ear && !HasEdge(star[prev[v]], *ring[prev[v]], c);
+    if (!ear) {
+      if (++misses > remaining) {
+        throw std::runtime_error("RemovePoint - hole can't be triangulated");
+      }
+      v = next[v];
+      continue;
+    }
+    corners.insert(corners.end(), { ring[prev[v]], ring[v], ring[next[v]] });
+    next[prev[v]] = next[v];
+    prev[next[v]] = prev[v];
+    v = prev[v];
+    remaining--;
+    misses = 0;
+    if (remaining == 3) {
+      corners.insert(corners.end(), { ring[prev[v]], ring[v], ring[next[v]] });
+    }
+  }
+  if (n == 3) {
+    corners.insert(corners.end(), { ring[0], ring[1], ring[2] });
+  }
+
+  // Two triangles less than before
+  created.assign(star.begin(), star.end() - 2);
+  tcx.RemoveTriangle(star[n - 2]);
+  tcx.RemoveTriangle(star[n - 1]);
+  for (size_t i = 0; i < created.size(); i++) {
+    Triangle* triangle = created[i];
+    tcx.ReuseTriangle(*triangle, *corners[3 * i], *corners[3 * i + 1], *corners[3 * i + 2]);
+    triangle->IsInterior(true);
+    for (const auto& edge : constrained) {
+      triangle->MarkConstrainedEdge(edge.first, edge.second);
+    }
+  }
+  LinkCavity(created, around);
+  tcx.locate_hint_ = created.front();
+  tcx.DropPoint(&point);
+  if (constrained_ends) {
+    *constrained_ends = ends;
+  }
+}
+
+void Sweep::RemoveConstraint(SweepContext& tcx, Point& p, Point& q)
+{
+  // Follow the constrained edges from p to q, there are several if vertices split the segment
+  std::vector<std::pair<Triangle*, int>> edges;
+  for (Point* start = &p; start != &q;) {
+    Triangle* t = tcx.LocateTriangle(*start);
+    if (!t || !t->Contains(start)) {
+      throw std::runtime_error("RemoveConstraint - not a vertex of the triangulation");
+    }
+    Point* along = nullptr;
+    t = FindSegmentStart(t, *start, q, along);
+    const int index = along ? t->EdgeIndex(start, along) : -1;
+    if (index < 0 || !t->constrained_edge[index]) {
+      throw std::runtime_error("RemoveConstraint - no constrained edge from p to q");
+    }
+    Triangle* other = t->GetNeighbor(index);
+    if (!t->IsInterior() || !other || !other->IsInterior()) {
+      throw std::runtime_error("RemoveConstraint - edge on the border of the triangulation");
+    }
+    edges.emplace_back(t, index);
+    start = along;
+  }
+
+  std::vector<Triangle*> triangles;
+  for (const auto& edge : edges) {
+    Triangle* t = edge.first;
+    Point* a = t->GetPoint((edge.second + 1) % 3);
+    Point* b = t->GetPoint((edge.second + 2) % 3);
+    Triangle* other = t->GetNeighbor(edge.second);
+    t->constrained_edge[edge.second] = false;
+    other->constrained_edge[other->EdgeIndex(a, b)] = false;
+    tcx.RemoveEdge(a, b);
+    triangles.push_back(t);
+    triangles.push_back(other);
+  }
+  LegalizeTriangles(triangles);
+}
+
+bool Sweep::Retriangulate(SweepContext& tcx)
+{
+  tcx.RemoveExteriorTriangles();
+  std::vector<Point*> detached;
+  bool repaired = FixInvertedTriangles(tcx, detached);
+  tcx.FreeRemovedTriangles();
+  repaired = repaired && !BorderIntersects(tcx.GetTriangles());
+  if (repaired) {
+    // All triangles have the right orientation inside of a simple border, so they don't
+    // overlap. Put back the points taken out on the way and make it Delaunay again.
+    try {
+      while (!detached.empty()) {
+        InsertPoint(tcx, *detached.back());
+        detached.pop_back();
+      }
+    } catch (std::runtime_error&) {
+      repaired = false;
+    }
+  }
+  if (repaired) {
+    std::vector<Triangle*> triangles = tcx.GetTriangles();
+    LegalizeTriangles(triangles);
+    SampleMemoryUsage(tcx, 0);
+    return true;
+  }
+
+  for (Point* point : detached) {
+    tcx.RestorePoint(point);
+  }
+  tcx.ResetTriangulation();
+  for (auto& node : nodes_) {
+    delete node;
+  }
+  nodes_.clear();
+  Triangulate(tcx);
+  return false;
+}
+
+bool Sweep::FixInvertedTriangles(SweepContext& tcx, std::vector<Point*>& detached)
+{
+  const auto inverted = [](Triangle* t) {
+    return t->IsInterior() && Orient2d(*t->GetPoint(0), *t->GetPoint(1), *t->GetPoint(2)) != CCW;
+  };
+  const std::vector<Triangle*>& triangles = tcx.GetTriangles();
+  std::vector<Triangle*> queue;
+  std::copy_if(triangles.begin(), triangles.end(), std::back_inserter(queue), inverted);
+
+  while (!queue.empty()) {
+    // Only flips that leave fewer inverted triangles are done, so this ends. Passes are
+    // repeated because a triangle may only become fixable after its neighbors were flipped.
+    bool progress = true;
+    while (!queue.empty() && progress) {
+      progress = false;
+      std::vector<Triangle*> remaining;
+      for (Triangle* t : queue) {
+        if (!inverted(t)) {
+          continue;
+        }
+        Triangle* flipped = nullptr;
+        for (int i = 0; i < 3 && !flipped; i++) {
+          Triangle* ot = t->GetNeighbor(i);
+          if (!ot || t->constrained_edge[i]) {
+            continue;
+          }
+          Point& p = *t->GetPoint(i);
+          Point& op = *ot->OppositePoint(*t, p);
+          const Point& a = *t->PointCCW(p);
+          const Point& b = *t->PointCW(p);
+          const int before = (Orient2d(p, a, b) != CCW) + (Orient2d(op, b, a) != CCW);
+          const int after = (Orient2d(p, a, op) != CCW) + (Orient2d(p, op, b) != CCW);
+          if (after < before && !HasEdge(t, p, op)) {
+            RotateTrianglePair(*t, p, *ot, op);
+            flipped = ot;
+          }
+        }
+        if (flipped) {
+          progress = true;
+          if (inverted(flipped)) {
+            remaining.push_back(flipped);
+          }
+        }
+        if (inverted(t)) {
+          remaining.push_back(t);
+        }
+      }
+      queue.swap(remaining);
+    }
+    if (queue.empty()) {
+      break;
+    }
+
+    // Flips can't untangle vertices that passed each other, take one of them out of the
+    // mesh instead. Its hole is triangulated without looking at where it is now.
+    bool removed = false;
+    for (size_t k = 0; k < queue.size() && !removed; k++) {
+      Triangle* t = queue[k];
+      for (int i = 0; i < 3 && inverted(t) && !removed; i++) {
+        Point& point = *t->GetPoint(i);
+        std::vector<Triangle*> created;
+        try {
+          RemoveVertex(tcx, *t, point, nullptr, created);
+        } catch (std::runtime_error&) {
+          // On the border or on a constrained edge
+          continue;
+        }
+        detached.push_back(&point);
+        std::copy_if(created.begin(), created.end(), std::back_inserter(queue), inverted);
+        removed = true;
+      }
+    }
+    if (!removed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Sweep::LegalizeTriangles(std::vector<Triangle*>& triangles) const
+{
+  while (!triangles.empty()) {
+    Triangle* t = triangles.back();
+    triangles.pop_back();
+    for (int i = 0; i < 3; i++) {
+      Triangle* ot = t->GetNeighbor(i);
+      if (!ot || t->constrained_edge[i]) {
+        continue;
+      }
+      Point* p = t->GetPoint(i);
+      Point* op = ot->OppositePoint(*t, *p);
+      if (Incircle(*p, *t->PointCCW(*p), *t->PointCW(*p), *op)) {
+        RotateTrianglePair(*t, *p, *ot, *op);
+        // Both triangles got two new edges
+        triangles.push_back(t);
+        triangles.push_back(ot);
+        break;
+      }
+    }
   }
 }
 
@@ -127,7 +1491,8 @@ void Sweep::EdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* triangl
   Orientation o1 = Orient2d(eq, *p1, ep);
   if (o1 == COLLINEAR) {
     if (triangle->Contains(&eq, p1)) {
-      triangle->MarkConstrainedEdge(&eq, p1);
+      // Marks the edge in the triangles on both sides of it
+      IsEdgeSideOfTriangle(*triangle, eq, *p1);
       // We are modifying the constraint maybe it would be better to
       // not change the given constraint and just keep a variable for the new constraint
       tcx.edge_event.constrained_edge->q = p1;
@@ -143,7 +1508,8 @@ void Sweep::EdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* triangl
   Orientation o2 = Orient2d(eq, *p2, ep);
   if (o2 == COLLINEAR) {
     if (triangle->Contains(&eq, p2)) {
-      triangle->MarkConstrainedEdge(&eq, p2);
+      // Marks the edge in the triangles on both sides of it
+      IsEdgeSideOfTriangle(*triangle, eq, *p2);
       // We are modifying the constraint maybe it would be better to
       // not change the given constraint and just keep a variable for the new constraint
       tcx.edge_event.constrained_edge->q = p2;
@@ -435,42 +1801,6 @@ bool Sweep::Legalize(SweepContext& tcx, Triangle& t)
   return false;
 }
 
-bool Sweep::Incircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd) const
-{
-  const double adx = pa.x - pd.x;
-  const double ady = pa.y - pd.y;
-  const double bdx = pb.x - pd.x;
-  const double bdy = pb.y - pd.y;
-
-  const double adxbdy = adx * bdy;
-  const double bdxady = bdx * ady;
-  const double oabd = adxbdy - bdxady;
-
-  if (oabd <= 0)
-    return false;
-
-  const double cdx = pc.x - pd.x;
-  const double cdy = pc.y - pd.y;
-
-  const double cdxady = cdx * ady;
-  const double adxcdy = adx * cdy;
-  const double ocad = cdxady - adxcdy;
-
-  if (ocad <= 0)
-    return false;
-
-  const double bdxcdy = bdx * cdy;
-  const double cdxbdy = cdx * bdy;
-
-  const double alift = adx * adx + ady * ady;
-  const double blift = bdx * bdx + bdy * bdy;
-  const double clift = cdx * cdx + cdy * cdy;
-
-  const double det = alift * (bdxcdy - cdxbdy) + blift * ocad + clift * oabd;
-
-  return det > 0;
-}
-
 void Sweep::RotateTrianglePair(Triangle& t, Point& p, Triangle& ot, Point& op) const
 {
   Triangle* n1, *n2, *n3, *n4;
@@ -768,6 +2098,26 @@ void Sweep::FlipEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* t,
       }
     } else {
       Orientation o = Orient2d(eq, op, ep);
+      if (o == COLLINEAR && p == eq && eq == *tcx.edge_event.constrained_edge->q &&
+          ep == *tcx.edge_event.constrained_edge->p) {
+        // op lies on the constrained edge and is connected to eq now, so split the edge there
+        // like EdgeEvent does for collinear points
+        t->MarkConstrainedEdge(&eq, &op);
+        ot.MarkConstrainedEdge(&eq, &op);
+        tcx.edge_event.constrained_edge->q = &op;
+        // Continue around op, but not from the triangles with eq, which lies on the same line
+        Triangle* next = t->NeighborAcross(eq);
+        if (next == nullptr) {
+          next = ot.NeighborAcross(eq);
+        }
+        if (next == nullptr) {
+          throw std::runtime_error("FlipEdgeEvent - no triangle across the split point");
+        }
+        EdgeEvent(tcx, ep, op, next, op);
+        Legalize(tcx, *t);
+        Legalize(tcx, ot);
+        return;
+      }
       t = &NextFlipTriangle(tcx, (int)o, *t, ot, p, op);
       FlipEdgeEvent(tcx, ep, eq, t, p);
     }
@@ -849,6 +2199,30 @@ void Sweep::FlipScanEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle&
   }
 }
 
+size_t Sweep::GetFrontMemoryUsage(const SweepContext& tcx) const
+{
+  size_t bytes = nodes_.capacity() * sizeof(Node*) + nodes_.size() * sizeof(Node);
+  if (tcx.front_) {
+    bytes += sizeof(AdvancingFront) + 3 * sizeof(Node);
+  }
+  return bytes;
+}
+
+MemoryUsage Sweep::GetPeakMemoryUsage() const
+{
+  return peak_memory_usage_;
+}
+
+void Sweep::SampleMemoryUsage(const SweepContext& tcx, size_t scratch)
+{
+  MemoryUsage usage = tcx.GetMemoryUsage();
+  usage.front_nodes = GetFrontMemoryUsage(tcx);
+  usage.scratch = scratch;
+  if (usage.Total() > peak_memory_usage_.Total()) {
+    peak_memory_usage_ = usage;
+  }
+}
+
 Sweep::~Sweep() {
 
     // Clean up memory
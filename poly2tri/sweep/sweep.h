@@ -38,6 +38,9 @@
 
 #pragma once
 
+#include "sweep_context.h"
+
+#include <cstddef>
 #include <vector>
 
 namespace p2t {
@@ -47,6 +50,7 @@ struct Node;
 struct Point;
 struct Edge;
 class Triangle;
+class TriangleVisitor;
 
 class Sweep
 {
@@ -56,22 +60,196 @@ public:
    * Triangulate
    *
    * @param tcx
+   * @param visitor - if set, interior triangles are passed to it instead of being collected
+   */
+  void Triangulate(SweepContext& tcx, TriangleVisitor* visitor = nullptr);
+
+  /**
+   * Insert a point into a finished triangulation: the triangle containing it (or the two
+   * triangles sharing the edge it lies on) is split and the neighborhood is flipped until it
+   * is constrained Delaunay again
+   *
+   * @param tcx
+   * @param point
+   */
+  void InsertPoint(SweepContext& tcx, Point& point);
+
+  /**
+   * Force the segment from p to q into a finished triangulation. Endpoints that aren't
+   * vertices yet are inserted first. The triangles crossed by the segment are replaced by the
+   * constrained Delaunay triangulation of the two pseudo-polygons on either side of it, vertices
+   * lying on the segment split it.
+   *
+   * @param tcx
+   * @param p
+   * @param q
+   */
+  void InsertConstraint(SweepContext& tcx, Point& p, Point& q);
+
+  /**
+   * Remove a vertex from a finished triangulation and fill the hole left by its triangles with
+   * their constrained Delaunay triangulation. A vertex splitting a constrained edge in two is
+   * removed together with the split.
+   *
+   * @param tcx
+   * @param point - a vertex that isn't on the border of the triangulation and doesn't end a
+   *                constrained edge
    */
-  void Triangulate(SweepContext& tcx);
+  void RemovePoint(SweepContext& tcx, Point& point);
+
+  /**
+   * Turn the constrained edges from p to q back into ordinary ones and flip them (and what
+   * follows) until the triangulation is constrained Delaunay again
+   *
+   * @param tcx
+   * @param p
+   * @param q
+   */
+  void RemoveConstraint(SweepContext& tcx, Point& p, Point& q);
+
+  /**
+   * Update a finished triangulation after its points moved. The triangles are kept and flipped
+   * until none is inverted and the triangulation is constrained Delaunay again, which is much
+   * cheaper than a new sweep for small motions. If that doesn't work out, e.g. because the
+   * border of the triangulation now intersects itself, the points are swept again.
+   *
+   * @param tcx
+   * @return false if the points had to be swept again
+   */
+  bool Retriangulate(SweepContext& tcx);
 
   /**
    * Destructor - clean up memory
    */
   ~Sweep();
 
+  /**
+   * Bytes held by the advancing front: the front itself, the three nodes SweepContext starts it
+   * with and the nodes created while sweeping
+   */
+  size_t GetFrontMemoryUsage(const SweepContext& tcx) const;
+
+  /**
+   * The largest memory usage sampled while triangulating. Samples are taken after each phase,
+   * including the temporary buffers alive then.
+   */
+  MemoryUsage GetPeakMemoryUsage() const;
+
 private:
 
+  /**
+   * Triangulate a y-monotone polyline without holes or Steiner points directly, without
+   * sorting or an advancing front: the monotone chains are triangulated in one pass and the
+   * result is flipped until it is constrained Delaunay. Convex polylines take
+   * TriangulateConvex instead.
+   *
+   * @param tcx
+   * @param visitor
+   * @return false if the polyline isn't y-monotone, nothing has been done in that case
+   */
+  bool TriangulateMonotone(SweepContext& tcx, TriangleVisitor* visitor);
+
+  /**
+   * Stack based triangulation of the two monotone chains between bottom and top
+   *
+   * @return false if a triangle would be degenerate or inverted, the latter if the chains cross
+   */
+  bool TriangulateMonotoneChains(const std::vector<Point*>& polygon, size_t bottom, size_t top,
+                                 bool ccw, std::vector<size_t>& triangles) const;
+
+  /**
+   * Delaunay triangulation of a strictly convex polygon with Chew's algorithm: vertices are
+   * removed in random order and put back one at a time, flipping as they go. Needs expected
+   * O(n) flips, while flipping an arbitrary triangulation of a convex polygon can take O(n²).
+   *
+   * @param polygon
+   * @param ring - indices into polygon in counter-clockwise order
+   * @param triangles - receives the counter-clockwise index triples
+   */
+  void TriangulateConvex(const std::vector<Point*>& polygon, const std::vector<size_t>& ring,
+                         std::vector<size_t>& triangles) const;
+
+  /**
+   * Find the interior triangle containing the point, or one of the two sharing the edge it
+   * lies on. Throws if the point is outside of the triangulation.
+   */
+  Triangle* LocateInteriorTriangle(SweepContext& tcx, const Point& point);
+
+  /**
+   * Walk along the segment from p to q without changing anything and throw if
+   * InsertConstraint couldn't insert it: it leaves the triangulated area, crosses a
+   * constrained edge or an endpoint repeats a vertex
+   */
+  void CheckSegment(SweepContext& tcx, Point& p, Point& q);
+
+  /**
+   * Find a triangle that has the point as a vertex, inserting the point if it isn't one yet
+   */
+  Triangle* LocateVertex(SweepContext& tcx, Point& point);
+
+  /**
+   * Flip the interior triangles until none is inverted or degenerate, without flipping
+   * constrained edges. Vertices that can't be fixed like that are taken out of the mesh.
+   *
+   * @param tcx
+   * @param detached - receives the vertices taken out, to be inserted again
+   * @return false if some triangles couldn't be fixed
+   */
+  bool FixInvertedTriangles(SweepContext& tcx, std::vector<Point*>& detached);
+
+  /**
+   * Take a vertex out of the mesh and fill the hole with ears of the polygon around it,
+   * reusing the triangles. Throws if that isn't possible.
+   *
+   * @param tcx
+   * @param triangle - a triangle with point as vertex
+   * @param point
+   * @param constrained_ends - receives the ends of the constrained edge that the vertex
+   *                           splits, nullptr to throw for any constrained edge at the vertex
+   * @param created - receives the triangles filling the hole
+   */
+  void RemoveVertex(SweepContext& tcx, Triangle& triangle, Point& point,
+                    std::vector<Point*>* constrained_ends, std::vector<Triangle*>& created);
+
+  /**
+   * Turn around the vertex p of t to the triangle that the segment from p to q leaves p through
+   *
+   * @param t - a triangle with p as vertex
+   * @param p
+   * @param q
+   * @param along - set to the other end of the edge instead if the segment runs along one
+   * @return the triangle, which has the edge from p to along if that is set
+   */
+  Triangle* FindSegmentStart(Triangle* t, Point& p, Point& q, Point*& along) const;
+
+  /**
+   * Recover the part of the segment from p to q up to the first vertex lying on it
+   *
+   * @param tcx
+   * @param t - a triangle with p as vertex
+   * @param p
+   * @param q
+   * @return the vertex the constrained edge ends at, q or a vertex between p and q
+   */
+  Point* RecoverSegment(SweepContext& tcx, Triangle* t, Point& p, Point& q);
+
+  /**
+   * Flip the non-constrained edges of the given triangles and of the triangles created by
+   * the flips until they are locally Delaunay. Unlike Legalize this doesn't touch the
+   * advancing front, so it works on finished triangulations.
+   *
+   * @param triangles - work list, empty on return
+   */
+  void LegalizeTriangles(std::vector<Triangle*>& triangles) const;
+
   /**
    * Start sweeping the Y-sorted point set from bottom to top
    *
    * @param tcx
+   * @param first - index of the point the advancing front was created with
+   * @param last - index after the last point to sweep
    */
-  void SweepPoints(SweepContext& tcx);
+  void SweepPoints(SweepContext& tcx, size_t first, size_t last);
 
   /**
    * Find closes node to the left of the new point and
@@ -117,32 +295,6 @@ private:
    */
   bool Legalize(SweepContext& tcx, Triangle& t);
 
-  /**
-   * <b>Requirement</b>:<br>
-   * 1. a,b and c form a triangle.<br>
-   * 2. a and d is know to be on opposite side of bc<br>
-   * <pre>
-   *                a
-   *                +
-   *               / \
-   *              /   \
-   *            b/     \c
-   *            +-------+
-   *           /    d    \
-   *          /           \
-   * </pre>
-   * <b>Fact</b>: d has to be in area B to have a chance to be inside the circle formed by
-   *  a,b and c<br>
-   *  d is outside B if orient2d(a,b,d) or orient2d(c,a,d) is CW<br>
-   *  This preknowledge gives us a way to optimize the incircle test
-   * @param a - triangle point, opposite d
-   * @param b - triangle point
-   * @param c - triangle point
-   * @param d - point opposite a
-   * @return true if d is inside circle, false if on circle edge
-   */
-  bool Incircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd) const;
-
   /**
    * Rotates a triangle pair one vertex CW
    *<pre>
@@ -274,9 +426,46 @@ private:
      */
   void FlipScanEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle& flip_triangle, Triangle& t, Point& p);
 
-  void FinalizationPolygon(SweepContext& tcx);
+  /**
+   * Collect the interior triangles after a sweep
+   *
+   * @param tcx
+   * @param visitor
+   * @param first - index in the triangle map of the first triangle the sweep created
+   */
+  void FinalizationPolygon(SweepContext& tcx, TriangleVisitor* visitor, size_t first);
+
+  /**
+   * Finish the triangulation of a point cloud: fill the advancing front up to the upper convex
+   * hull, then flip away the edges to the artificial points until the points are triangulated
+   * up to their convex hull. The hull edges are marked as constrained, and the others flipped
+   * until they are all locally Delaunay.
+   *
+   * @param tcx
+   * @param visitor
+   */
+  void FinalizationPointCloud(SweepContext& tcx, TriangleVisitor* visitor);
+
+  /**
+   * Look for neighbors a and c of point with only artificial points between them, less than
+   * 180 degrees apart. Flips the edges to those artificial points until the triangle a, point,
+   * c exists. The points whose neighbors changed are added to work.
+   *
+   * @return the new triangle, nullptr if there was none to make
+   */
+  Triangle* CloseHullAt(SweepContext& tcx, Point& point, Triangle& triangle,
+                        std::vector<std::pair<Point*, Triangle*>>& work);
+
+  /**
+   * Sample the memory usage of tcx and this sweep for the peak
+   *
+   * @param tcx
+   * @param scratch - bytes of the temporary buffers alive at this point
+   */
+  void SampleMemoryUsage(const SweepContext& tcx, size_t scratch);
 
   std::vector<Node*> nodes_;
+  MemoryUsage peak_memory_usage_;
 
 };
 
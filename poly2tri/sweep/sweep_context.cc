@@ -31,10 +31,30 @@
 #include "sweep_context.h"
 #include <algorithm>
 #include "advancing_front.h"
+#include "../common/utils.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_set>
 
 namespace p2t {
 
 SweepContext::SweepContext(std::vector<Point*> polyline) : points_(std::move(polyline)),
+  polyline_size_(points_.size()),
+  monotone_fast_path_(false),
+  split_intersections_(false),
+  weld_tolerance_(-1),
+  polyline_count_(points_.empty() ? 0 : 1),
+  fill_rule_(FillRule::EvenOdd),
+  locate_hint_(nullptr),
+  removed_edges_(0),
+  scratch_memory_usage_(0),
   front_(nullptr),
   head_(nullptr),
   tail_(nullptr),
@@ -43,18 +63,61 @@ SweepContext::SweepContext(std::vector<Point*> polyline) : points_(std::move(pol
   af_tail_(nullptr)
 {
   InitEdges(points_);
+  input_points_ = points_;
+  if (!points_.empty()) {
+    polyline_starts_.push_back(0);
+  }
 }
 
 void SweepContext::AddHole(const std::vector<Point*>& polyline)
 {
+  polyline_starts_.push_back(points_.size());
   InitEdges(polyline);
   for (auto i : polyline) {
     points_.push_back(i);
   }
+  input_points_.insert(input_points_.end(), polyline.begin(), polyline.end());
+}
+
+void SweepContext::AddPolyline(const std::vector<Point*>& polyline)
+{
+  if (points_.empty()) {
+    // The first one, as if it was passed to the constructor
+    polyline_size_ = polyline.size();
+  }
+  polyline_starts_.push_back(points_.size());
+  InitEdges(polyline);
+  points_.insert(points_.end(), polyline.begin(), polyline.end());
+  input_points_.insert(input_points_.end(), polyline.begin(), polyline.end());
+  polyline_count_++;
 }
 
 void SweepContext::AddPoint(Point* point) {
+  polyline_starts_.push_back(points_.size());
   points_.push_back(point);
+  input_points_.push_back(point);
+}
+
+void SweepContext::AddRing(const std::vector<Point*>& ring)
+{
+  const size_t num_points = ring.size();
+  for (size_t i = 0; i < num_points; i++) {
+    Point* p = ring[i];
+    Point* q = ring[i < num_points - 1 ? i + 1 : 0];
+    if (ring_points_.insert(p).second) {
+      points_.push_back(p);
+      input_points_.push_back(p);
+    }
+    // The edge is in the edge list of its upper point
+    const auto shared = [p, q](const Edge* edge) {
+      return (edge->p == p && edge->q == q) || (edge->p == q && edge->q == p);
+    };
+    if (std::none_of(p->edge_list.begin(), p->edge_list.end(), shared) &&
+        std::none_of(q->edge_list.begin(), q->edge_list.end(), shared)) {
+      edge_list.push_back(new Edge(*p, *q));
+    }
+  }
+  rings_.push_back(ring);
 }
 
 std::vector<Triangle*> &SweepContext::GetTriangles()
@@ -62,19 +125,280 @@ std::vector<Triangle*> &SweepContext::GetTriangles()
   return triangles_;
 }
 
-std::list<Triangle*> &SweepContext::GetMap()
+std::vector<Triangle*> &SweepContext::GetMap()
 {
   return map_;
 }
 
-void SweepContext::InitTriangulation()
+bool SweepContext::IsTriangulated() const
+{
+  return !triangles_.empty();
+}
+
+Triangle* SweepContext::AddInteriorTriangle(Point& a, Point& b, Point& c)
+{
+  Triangle* triangle = new Triangle(a, b, c);
+  AddToMap(triangle);
+  triangle->interior_index_ = static_cast<uint32_t>(triangles_.size());
+  triangles_.push_back(triangle);
+  triangle->IsInterior(true);
+  labels_.clear();
+  return triangle;
+}
+
+void SweepContext::ReuseTriangle(Triangle& triangle, Point& a, Point& b, Point& c)
+{
+  const uint32_t map_index = triangle.map_index_;
+  const uint32_t interior_index = triangle.interior_index_;
+  triangle = Triangle(a, b, c);
+  triangle.map_index_ = map_index;
+  triangle.interior_index_ = interior_index;
+}
+
+void SweepContext::RemoveTriangle(Triangle* triangle)
+{
+  labels_.clear();
+  // Not interior anymore, so LocateTriangle skips it
+  triangle->ClearNeighbors();
+  triangle->IsInterior(false);
+  removed_triangles_.push_back(triangle);
+  if (locate_hint_ == triangle) {
+    locate_hint_ = nullptr;
+  }
+}
+
+void SweepContext::FreeRemovedTriangles()
+{
+  if (removed_triangles_.empty()) {
+    return;
+  }
+  for (Triangle* t : removed_triangles_) {
+    Triangle* last = triangles_.back();
+    triangles_[t->interior_index_] = last;
+    last->interior_index_ = t->interior_index_;
+    triangles_.pop_back();
+    last = map_.back();
+    map_[t->map_index_] = last;
+    last->map_index_ = t->map_index_;
+    map_.pop_back();
+    delete t;
+  }
+  removed_triangles_.clear();
+}
+
+namespace {
+
+/// Take the edge between p and q out of the edge list of its upper point, nullptr if there is none
+Edge* DetachEdge(const Point* p, const Point* q)
+{
+  for (const Point* upper : { p, q }) {
+    const Point* lower = upper == p ? q : p;
+    for (Edge* edge : upper->edge_list) {
+      if (edge->p == lower) {
+        auto& edges = edge->q->edge_list;
+        edges.erase(std::find(edges.begin(), edges.end(), edge));
+        return edge;
+      }
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+void SweepContext::RemoveEdge(const Point* p, const Point* q)
+{
+  if (Edge* edge = DetachEdge(p, q)) {
+    edge->p = edge->q = nullptr;
+    removed_edges_++;
+  }
+}
+
+void SweepContext::SplitEdge(const Point* p, const Point* q, Point& point)
+{
+  if (Edge* edge = DetachEdge(p, q)) {
+    Point& lower_end = *edge->p;
+    Point& upper_end = *edge->q;
+    edge->p = edge->q = nullptr;
+    removed_edges_++;
+    edge_list.push_back(new Edge(lower_end, point));
+    edge_list.push_back(new Edge(point, upper_end));
+  }
+}
+
+void SweepContext::DropPoint(Point* point)
+{
+  dropped_points_.insert(point);
+}
+
+void SweepContext::RestorePoint(Point* point)
+{
+  if (!dropped_points_.erase(point)) {
+    points_.push_back(point);
+  }
+}
+
+void SweepContext::PurgeRemoved()
+{
+  if (removed_edges_ > 0) {
+    edge_list.erase(std::remove_if(edge_list.begin(), edge_list.end(),
+                                   [](Edge* edge) {
+                                     if (edge->p) {
+                                       return false;
+                                     }
+                                     delete edge;
+                                     return true;
+                                   }),
+                    edge_list.end());
+    removed_edges_ = 0;
+  }
+  if (!dropped_points_.empty()) {
+    points_.erase(std::remove_if(points_.begin(), points_.end(),
+                                 [this](Point* point) { return dropped_points_.count(point) > 0; }),
+                  points_.end());
+    dropped_points_.clear();
+  }
+}
+
+namespace {
+
+/// Index of an edge of the triangle that the point lies beyond, 3 if it contains the point
+int EdgeBeyond(Triangle& t, const Point& point)
+{
+  int edge = 0;
+  while (edge < 3 &&
+         Orient2d(*t.GetPoint((edge + 1) % 3), *t.GetPoint((edge + 2) % 3), point) != CW) {
+    edge++;
+  }
+  return edge;
+}
+
+} // namespace
+
+Triangle* SweepContext::LocateTriangle(const Point& point)
+{
+  // Jump and walk: start at whichever is closest of the last located triangle and about
+  // cbrt(n) samples, which makes the expected walk O(cbrt(n)) for random points
+  Triangle* t = locate_hint_ ? locate_hint_ : (map_.empty() ? nullptr : map_.front());
+  const auto distance = [&point](Triangle* triangle) {
+    const Point& corner = *triangle->GetPoint(0);
+    const double dx = corner.x - point.x;
+    const double dy = corner.y - point.y;
+    return dx * dx + dy * dy;
+  };
+  if (t) {
+    double closest = distance(t);
+    const size_t samples = 1 + static_cast<size_t>(std::cbrt(triangles_.size()));
+    const size_t stride = std::max<size_t>(1, triangles_.size() / samples);
+    for (size_t i = stride / 2; i < triangles_.size(); i += stride) {
+      if (!triangles_[i]->IsInterior()) {
+        // Removed
+        continue;
+      }
+      const double d = distance(triangles_[i]);
+      if (d < closest) {
+        closest = d;
+        t = triangles_[i];
+      }
+    }
+  }
+  // Then step over an edge the point lies beyond. This can cycle in triangulations that aren't
+  // Delaunay, so the number of steps is limited.
+  for (size_t steps = 0; t && steps <= map_.size(); steps++) {
+    const int edge = EdgeBeyond(*t, point);
+    if (edge == 3) {
+      locate_hint_ = t;
+      return t;
+    }
+    t = t->GetNeighbor(edge);
+  }
+  for (Triangle* candidate : triangles_) {
+    if (candidate->IsInterior() && EdgeBeyond(*candidate, point) == 3) {
+      locate_hint_ = candidate;
+      return candidate;
+    }
+  }
+  return nullptr;
+}
+
+void SweepContext::RemoveExteriorTriangles()
 {
-  double xmax(points_[0]->x), xmin(points_[0]->x);
-  double ymax(points_[0]->y), ymin(points_[0]->y);
+  if (map_.size() == triangles_.size()) {
+    return;
+  }
+  for (Triangle* t : triangles_) {
+    for (int i = 0; i < 3; i++) {
+      Triangle* neighbor = t->GetNeighbor(i);
+      if (neighbor && !neighbor->IsInterior()) {
+        t->ClearNeighbor(neighbor);
+      }
+    }
+  }
+  map_.erase(std::remove_if(map_.begin(), map_.end(),
+                            [](Triangle* t) {
+                              if (t->IsInterior()) {
+                                return false;
+                              }
+                              delete t;
+                              return true;
+                            }),
+             map_.end());
+  for (size_t i = 0; i < map_.size(); i++) {
+    map_[i]->map_index_ = static_cast<uint32_t>(i);
+  }
+  if (locate_hint_ && !locate_hint_->IsInterior()) {
+    locate_hint_ = nullptr;
+  }
+}
+
+void SweepContext::ResetTriangulation()
+{
+  PurgeRemoved();
+  for (Edge* edge : edge_list) {
+    if (*edge->p == *edge->q) {
+      throw std::runtime_error("SweepContext::ResetTriangulation - repeat points");
+    }
+  }
+  for (auto point : points_) {
+    point->edge_list.clear();
+  }
+  for (Edge* edge : edge_list) {
+    if (cmp(edge->q, edge->p)) {
+      std::swap(edge->p, edge->q);
+    }
+    edge->q->edge_list.push_back(edge);
+  }
+
+  for (auto ptr : map_) {
+    delete ptr;
+  }
+  map_.clear();
+  triangles_.clear();
+  labels_.clear();
+  removed_triangles_.clear();
+  locate_hint_ = nullptr;
+
+  for (Point* point : artificial_points_) {
+    delete point;
+  }
+  artificial_points_.clear();
+  delete front_;
+  delete af_head_;
+  delete af_middle_;
+  delete af_tail_;
+  head_ = tail_ = nullptr;
+  front_ = nullptr;
+  af_head_ = af_middle_ = af_tail_ = nullptr;
+}
+
+void SweepContext::InitTriangulation(size_t first, size_t last)
+{
+  double xmax(points_[first]->x), xmin(points_[first]->x);
+  double ymax(points_[first]->y), ymin(points_[first]->y);
 
   // Calculate bounds.
-  for (auto& point : points_) {
-    Point& p = *point;
+  for (size_t i = first; i < last; i++) {
+    Point& p = *points_[i];
     if (p.x > xmax)
       xmax = p.x;
     if (p.x < xmin)
@@ -87,12 +411,501 @@ void SweepContext::InitTriangulation()
 
   double dx = kAlpha * (xmax - xmin);
   double dy = kAlpha * (ymax - ymin);
+#ifdef P2T_INTEGER_COORDINATES
+  // Exact predicates need integers
+  head_ = new Point(std::floor(xmin - dx), std::floor(ymin - dy));
+  tail_ = new Point(std::ceil(xmax + dx), std::floor(ymin - dy));
+#else
   head_ = new Point(xmin - dx, ymin - dy);
   tail_ = new Point(xmax + dx, ymin - dy);
+#endif
+  artificial_points_.push_back(head_);
+  artificial_points_.push_back(tail_);
 
   // Sort points along y-axis
-  std::sort(points_.begin(), points_.end(), cmp);
+  std::sort(points_.begin() + first, points_.begin() + last, cmp);
+  // The polyline can't be told apart from the other points anymore
+  polyline_size_ = 0;
+  polyline_starts_.clear();
+}
+
+namespace {
+
+/// Whether c lies strictly between a and b, which are ordered by cmp, given all are collinear
+bool Between(const Point* a, const Point* b, const Point* c)
+{
+  return cmp(a, c) && cmp(c, b);
+}
+
+/// Where something happens to the edges in SweepContext::SplitCrossings
+struct SplitEvent {
+  enum Type { kEnd, kCrossing, kStart };
+  Scalar x;
+  Scalar y;
+  Type type;
+  /// The edge that starts or ends, or the two that cross
+  size_t first;
+  size_t second;
+};
+
+/// Orders a priority queue of SplitEvent like cmp orders points, ends before crossings before
+/// starts at the same point
+struct LaterEvent {
+  bool operator()(const SplitEvent& a, const SplitEvent& b) const
+  {
+    return std::tie(a.y, a.x, a.type) > std::tie(b.y, b.x, b.type);
+  }
+};
+
+/// Place of an edge on the sweep line, two crossing edges swap places
+struct SweepSlot {
+  mutable size_t edge;
+};
+
+/// Whether edge g, which starts on the sweep line, lies left of edge f there, or right above if
+/// it starts on f. Overlapping edges are ordered by index.
+bool StartsLeftOf(const std::vector<Edge*>& edges, size_t g, size_t f)
+{
+  const Edge& line = *edges[f];
+  Orientation side = Orient2d(*line.p, *line.q, *edges[g]->p);
+  if (side == COLLINEAR) {
+    side = Orient2d(*line.p, *line.q, *edges[g]->q);
+  }
+  if (side == COLLINEAR) {
+    return g < f;
+  }
+  return side == CCW;
+}
+
+/// Bytes of an unordered container: the buckets and a node per element
+template <class Hash>
+size_t HashBytes(const Hash& hash)
+{
+  return hash.bucket_count() * sizeof(void*) +
+         hash.size() * (sizeof(typename Hash::value_type) + sizeof(void*));
+}
+
+/// Bytes of a std::map: a node with three links and the color per element
+template <class Tree>
+size_t TreeBytes(const Tree& tree)
+{
+  return tree.size() * (sizeof(typename Tree::value_type) + 4 * sizeof(void*));
+}
+
+} // namespace
+
+std::pair<const Point*, const Point*> SweepContext::MultiplicityKey(const Point* p,
+                                                                    const Point* q)
+{
+  return std::less<const Point*>()(p, q) ? std::make_pair(p, q) : std::make_pair(q, p);
+}
+
+int SweepContext::edge_multiplicity(const Point* p, const Point* q) const
+{
+  const auto it = edge_multiplicity_.find(MultiplicityKey(p, q));
+  return it == edge_multiplicity_.end() ? 1 : it->second;
+}
+
+bool SweepContext::SplitIntersections()
+{
+  bool split = false;
+  bool moved = true;
+  size_t most_scratch = 0;
+  while (moved) {
+    moved = false;
+    split = SplitCrossings(moved) || split;
+    most_scratch = std::max(most_scratch, scratch_memory_usage_);
+  }
+  scratch_memory_usage_ = most_scratch;
+  return split;
+}
+
+bool SweepContext::SplitCrossings(bool& moved)
+{
+  // Bentley-Ottmann: sweep the edges upwards in the order of cmp, keeping the ones that cross the
+  // sweep line ordered from left to right. Two edges can only meet after being next to each other.
+  const std::vector<Edge*> edges(edge_list);
+  std::unordered_map<Edge*, std::vector<Point*>> splits;
+  // A crossing can fall exactly onto a vertex of a third edge
+  std::map<std::pair<double, double>, Point*> created;
+  for (Point* point : points_) {
+    created.emplace(std::make_pair(point->x, point->y), point);
+  }
+
+  std::priority_queue<SplitEvent, std::vector<SplitEvent>, LaterEvent> events;
+  for (size_t i = 0; i < edges.size(); i++) {
+    events.push({ edges[i]->p->x, edges[i]->p->y, SplitEvent::kStart, i, i });
+    events.push({ edges[i]->q->x, edges[i]->q->y, SplitEvent::kEnd, i, i });
+  }
+  size_t most_events = events.size();
+  // Compares the edge being inserted, the only one that starts on the sweep line, with the others
+  size_t inserting = 0;
+  const auto left = [&edges, &inserting](const SweepSlot& a, const SweepSlot& b) {
+    if (a.edge == inserting) {
+      return StartsLeftOf(edges, a.edge, b.edge);
+    }
+    return b.edge == inserting && !StartsLeftOf(edges, b.edge, a.edge);
+  };
+  std::set<SweepSlot, decltype(left)> status(left);
+  size_t most_active = 0;
+  std::vector<std::set<SweepSlot, decltype(left)>::iterator> where(edges.size());
+  // Pairs of edges tested against each other, and the crossing ones that swapped places
+  const auto key = [&edges](size_t i, size_t j) {
+    return static_cast<uint64_t>(std::min(i, j)) * edges.size() + std::max(i, j);
+  };
+  std::unordered_set<uint64_t> met;
+  std::unordered_set<uint64_t> swapped;
+  Scalar sweep_x = -INFINITY, sweep_y = -INFINITY;
+
+  const auto meet = [&](size_t i, size_t j) {
+    if (!met.insert(key(i, j)).second) {
+      return;
+    }
+    Edge* e = edges[i];
+    Edge* f = edges[j];
+    const Point& a = *e->p;
+    const Point& b = *e->q;
+    const Point& c = *f->p;
+    const Point& d = *f->q;
+    if (std::max(a.x, b.x) < std::min(c.x, d.x) || std::max(c.x, d.x) < std::min(a.x, b.x)) {
+      return;
+    }
+    const Orientation c_side = Orient2d(a, b, c);
+    const Orientation d_side = Orient2d(a, b, d);
+    const Orientation a_side = Orient2d(c, d, a);
+    const Orientation b_side = Orient2d(c, d, b);
+    if (c_side != COLLINEAR && d_side != COLLINEAR && c_side != d_side &&
+        a_side != COLLINEAR && b_side != COLLINEAR && a_side != b_side) {
+      const double denominator = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+      const double t = ((c.x - a.x) * (d.y - c.y) - (c.y - a.y) * (d.x - c.x)) / denominator;
+      const double exact_x = a.x + t * (b.x - a.x);
+      const double exact_y = a.y + t * (b.y - a.y);
+#ifdef P2T_INTEGER_COORDINATES
+      // Exact predicates need integers, the edges bend by at most half a unit
+      const double x = std::round(exact_x);
+      const double y = std::round(exact_y);
+#else
+      const double x = exact_x;
+      const double y = exact_y;
+#endif
+      // Crossings of three edges at one point round to points apart by a few ulps, which the
+      // sweep can't separate
+      const double tolerance = EPSILON * std::max({ 1.0, std::abs(x), std::abs(y) });
+      Point* point = nullptr;
+      for (auto it = created.lower_bound({ x - tolerance, -INFINITY });
+           it != created.end() && it->first.first <= x + tolerance; ++it) {
+        if (std::abs(it->first.second - y) <= tolerance) {
+          point = it->second;
+          break;
+        }
+      }
+      if (!point) {
+        point = new Point(x, y);
+        created.emplace(std::make_pair(x, y), point);
+        intersections_.push_back(point);
+        if (!point_index_.empty()) {
+          // After the input points, which IndexPoints has seen already
+          point_index_.emplace(point, point_index_.size());
+        }
+        points_.push_back(point);
+        input_points_.push_back(point);
+      }
+      // Rounding can move the crossing onto an end of one of the edges, which doesn't split it
+      if (point != e->p && point != e->q) {
+        splits[e].push_back(point);
+      }
+      if (point != f->p && point != f->q) {
+        splits[f].push_back(point);
+      }
+#ifdef P2T_INTEGER_COORDINATES
+      const bool bent = Orient2d(a, b, *point) != COLLINEAR || Orient2d(c, d, *point) != COLLINEAR;
+#else
+      const bool bent = point->x != x || point->y != y;
+#endif
+      // The pieces leave the edges and can cross others, which another pass finds
+      moved = moved || bent;
+      if (!swapped.count(key(i, j))) {
+        // Not before the sweep line, where rounding can put it
+        const Scalar event_x = static_cast<Scalar>(exact_x);
+        const Scalar event_y = static_cast<Scalar>(exact_y);
+        const bool behind = event_y < sweep_y || (event_y == sweep_y && event_x < sweep_x);
+        events.push({ behind ? sweep_x : event_x, behind ? sweep_y : event_y,
+                      SplitEvent::kCrossing, i, j });
+        most_events = std::max(most_events, events.size());
+      }
+      return;
+    }
+    // Touching or overlapping
+    if (c_side == COLLINEAR && Between(&a, &b, &c)) {
+      splits[e].push_back(f->p);
+    }
+    if (d_side == COLLINEAR && Between(&a, &b, &d)) {
+      splits[e].push_back(f->q);
+    }
+    if (a_side == COLLINEAR && Between(&c, &d, &a)) {
+      splits[f].push_back(e->p);
+    }
+    if (b_side == COLLINEAR && Between(&c, &d, &b)) {
+      splits[f].push_back(e->q);
+    }
+  };
+  // Meet the neighbors of an edge, and on each side the edges beyond them as long as they pass
+  // through the point, which lies on all of them
+  const auto meet_through = [&](size_t i, const Point& point) {
+    const auto through = [&edges, &point](size_t j) {
+      return Orient2d(*edges[j]->p, *edges[j]->q, point) == COLLINEAR;
+    };
+    for (auto it = where[i]; it != status.begin();) {
+      --it;
+      meet(i, it->edge);
+      if (!through(it->edge)) {
+        break;
+      }
+    }
+    for (auto it = std::next(where[i]); it != status.end(); ++it) {
+      meet(i, it->edge);
+      if (!through(it->edge)) {
+        break;
+      }
+    }
+  };
 
+  while (!events.empty()) {
+    const SplitEvent event = events.top();
+    events.pop();
+    sweep_x = event.x;
+    sweep_y = event.y;
+    if (event.type == SplitEvent::kStart) {
+      inserting = event.first;
+      where[event.first] = status.insert(SweepSlot{ event.first }).first;
+      most_active = std::max(most_active, status.size());
+      meet_through(event.first, *edges[event.first]->p);
+    } else if (event.type == SplitEvent::kEnd) {
+      meet_through(event.first, *edges[event.first]->q);
+      const auto it = where[event.first];
+      if (it != status.begin() && std::next(it) != status.end()) {
+        meet(std::prev(it)->edge, std::next(it)->edge);
+      }
+      status.erase(it);
+    } else {
+      size_t i = event.first, j = event.second;
+      if (std::next(where[j]) == where[i]) {
+        std::swap(i, j);
+      }
+      if (std::next(where[i]) != where[j]) {
+        // Other edges crossing at the same point are still in between, meeting again when next
+        // to each other schedules the crossing again
+        met.erase(key(i, j));
+        continue;
+      }
+      // j is left of i from here on
+      where[i]->edge = j;
+      where[j]->edge = i;
+      std::swap(where[i], where[j]);
+      swapped.insert(key(i, j));
+      if (where[j] != status.begin()) {
+        meet(std::prev(where[j])->edge, j);
+      }
+      if (std::next(where[i]) != status.end()) {
+        meet(i, std::next(where[i])->edge);
+      }
+    }
+  }
+  scratch_memory_usage_ = edges.capacity() * sizeof(Edge*) +
+                          most_active * (sizeof(SweepSlot) + 4 * sizeof(void*)) +
+                          where.capacity() * sizeof(where[0]) + most_events * sizeof(SplitEvent) +
+                          HashBytes(met) + HashBytes(swapped) + HashBytes(splits) +
+                          TreeBytes(created);
+  for (const auto& split : splits) {
+    scratch_memory_usage_ += split.second.capacity() * sizeof(Point*);
+  }
+  if (splits.empty()) {
+    return false;
+  }
+
+  // Replace the split edges by chains of edges, which rings are updated with
+  std::map<std::pair<const Point*, const Point*>, std::vector<Point*>> chains;
+  std::vector<Edge*> kept_and_pieces;
+  for (Edge* edge : edge_list) {
+    if (splits.count(edge)) {
+      auto& upper = edge->q->edge_list;
+      upper.erase(std::remove(upper.begin(), upper.end(), edge), upper.end());
+    } else {
+      kept_and_pieces.push_back(edge);
+    }
+  }
+  for (Edge* edge : edge_list) {
+    auto it = splits.find(edge);
+    if (it == splits.end()) {
+      continue;
+    }
+    std::vector<Point*>& chain = it->second;
+    chain.push_back(edge->p);
+    chain.push_back(edge->q);
+    // Along the edge, rounded crossings can lie a bit beside it where cmp orders them differently
+    const Point& lower = *edge->p;
+    const Point direction = *edge->q - lower;
+    std::sort(chain.begin(), chain.end(), [&lower, &direction](const Point* a, const Point* b) {
+      const Real along_a = Dot(*a - lower, direction);
+      const Real along_b = Dot(*b - lower, direction);
+      return along_a < along_b || (along_a == along_b && cmp(a, b));
+    });
+    chain.erase(std::unique(chain.begin(), chain.end()), chain.end());
+    const int multiplicity = edge_multiplicity(edge->p, edge->q);
+    edge_multiplicity_.erase(MultiplicityKey(edge->p, edge->q));
+    for (size_t i = 0; i + 1 < chain.size(); i++) {
+      Point* p = chain[i];
+      Point* q = chain[i + 1];
+      // Overlapping edges have pieces in common, which lie on all of them
+      const auto same = [p](const Edge* e) { return e->p == p; };
+      if (std::none_of(q->edge_list.begin(), q->edge_list.end(), same)) {
+        kept_and_pieces.push_back(new Edge(*p, *q));
+        if (multiplicity != 1) {
+          edge_multiplicity_[MultiplicityKey(p, q)] = multiplicity;
+        }
+      } else {
+        edge_multiplicity_[MultiplicityKey(p, q)] = edge_multiplicity(p, q) + multiplicity;
+      }
+    }
+    chains.emplace(std::make_pair(edge->p, edge->q), std::move(chain));
+  }
+  for (auto& split : splits) {
+    delete split.first;
+  }
+  edge_list.swap(kept_and_pieces);
+  scratch_memory_usage_ += TreeBytes(chains) + kept_and_pieces.capacity() * sizeof(Edge*);
+
+  for (std::vector<Point*>& ring : rings_) {
+    std::vector<Point*> split_ring;
+    for (size_t i = 0; i < ring.size(); i++) {
+      Point* p = ring[i];
+      Point* q = ring[i < ring.size() - 1 ? i + 1 : 0];
+      const bool upwards = cmp(p, q);
+      const auto it = chains.find(upwards ? std::make_pair(p, q) : std::make_pair(q, p));
+      if (it == chains.end()) {
+        split_ring.push_back(p);
+      } else if (upwards) {
+        split_ring.insert(split_ring.end(), it->second.begin(), it->second.end() - 1);
+      } else {
+        split_ring.insert(split_ring.end(), it->second.rbegin(), it->second.rend() - 1);
+      }
+    }
+    ring.swap(split_ring);
+  }
+  return true;
+}
+
+namespace {
+
+struct CellHash {
+  size_t operator()(const std::pair<double, double>& cell) const
+  {
+    const std::hash<double> hash;
+    return hash(cell.first) * 31 + hash(cell.second);
+  }
+};
+
+/// Cell of the hash grid, the coordinates themselves for exact welding
+std::pair<double, double> Cell(const Point& point, double tolerance)
+{
+  if (tolerance > 0) {
+    return { std::floor(point.x / tolerance), std::floor(point.y / tolerance) };
+  }
+  return { point.x, point.y };
+}
+
+} // namespace
+
+bool SweepContext::WeldPoints()
+{
+  const double tolerance = weld_tolerance_;
+  // Points a cell apart can be within the tolerance, exact duplicates share a cell
+  const int reach = tolerance > 0 ? 1 : 0;
+  std::unordered_multimap<std::pair<double, double>, Point*, CellHash> grid;
+  grid.reserve(points_.size());
+  std::unordered_map<const Point*, Point*> merged;
+  std::vector<Point*> kept;
+  kept.reserve(points_.size());
+  size_t polyline_kept = 0;
+  for (size_t i = 0; i < points_.size(); i++) {
+    Point* point = points_[i];
+    const std::pair<double, double> cell = Cell(*point, tolerance);
+    Point* into = nullptr;
+    for (int dx = -reach; dx <= reach && !into; dx++) {
+      for (int dy = -reach; dy <= reach && !into; dy++) {
+        const auto range = grid.equal_range({ cell.first + dx, cell.second + dy });
+        for (auto it = range.first; it != range.second; ++it) {
+          const double x = it->second->x - point->x;
+          const double y = it->second->y - point->y;
+          if (x * x + y * y <= tolerance * tolerance) {
+            into = it->second;
+            break;
+          }
+        }
+      }
+    }
+    if (into) {
+      merged.emplace(point, into);
+      welds_.emplace_back(point, into);
+    } else {
+      grid.emplace(cell, point);
+      kept.push_back(point);
+      polyline_kept += i < polyline_size_ ? 1 : 0;
+    }
+  }
+  scratch_memory_usage_ = HashBytes(grid) + HashBytes(merged) + kept.capacity() * sizeof(Point*);
+  if (merged.empty()) {
+    return false;
+  }
+  for (Point* point : points_) {
+    point->edge_list.clear();
+  }
+  points_.swap(kept);
+  polyline_size_ = polyline_kept;
+
+  const auto weld = [&merged](Point* point) {
+    const auto it = merged.find(point);
+    return it == merged.end() ? point : it->second;
+  };
+  std::vector<Edge*> welded_edges;
+  welded_edges.reserve(edge_list.size());
+  for (Edge* edge : edge_list) {
+    Point* p = weld(edge->p);
+    Point* q = weld(edge->q);
+    if (cmp(q, p)) {
+      std::swap(p, q);
+    }
+    // Collapsed, or the same as another edge now
+    const auto same = [p](const Edge* e) { return e->p == p; };
+    if (p == q || std::any_of(q->edge_list.begin(), q->edge_list.end(), same)) {
+      delete edge;
+      continue;
+    }
+    edge->p = p;
+    edge->q = q;
+    q->edge_list.push_back(edge);
+    welded_edges.push_back(edge);
+  }
+  edge_list.swap(welded_edges);
+  scratch_memory_usage_ += welded_edges.capacity() * sizeof(Edge*);
+
+  for (std::vector<Point*>& ring : rings_) {
+    std::vector<Point*> welded_ring;
+    for (Point* point : ring) {
+      point = weld(point);
+      if (welded_ring.empty() || welded_ring.back() != point) {
+        welded_ring.push_back(point);
+      }
+    }
+    while (welded_ring.size() > 1 && welded_ring.back() == welded_ring.front()) {
+      welded_ring.pop_back();
+    }
+    ring.swap(welded_ring);
+  }
+  for (const auto& point : merged) {
+    ring_points_.erase(point.first);
+  }
+  return true;
 }
 
 void SweepContext::InitEdges(const std::vector<Point*>& polyline)
@@ -111,6 +924,7 @@ Point* SweepContext::GetPoint(size_t index)
 
 void SweepContext::AddToMap(Triangle* triangle)
 {
+  triangle->map_index_ = static_cast<uint32_t>(map_.size());
   map_.push_back(triangle);
 }
 
@@ -120,13 +934,17 @@ Node* SweepContext::LocateNode(const Point& point)
   return front_->LocateNode(point.x);
 }
 
-void SweepContext::CreateAdvancingFront()
+void SweepContext::CreateAdvancingFront(size_t first)
 {
+  delete front_;
+  delete af_head_;
+  delete af_middle_;
+  delete af_tail_;
 
   // Initial triangle
-  Triangle* triangle = new Triangle(*points_[0], *head_, *tail_);
+  Triangle* triangle = new Triangle(*points_[first], *head_, *tail_);
 
-  map_.push_back(triangle);
+  AddToMap(triangle);
 
   af_head_ = new Node(*triangle->GetPoint(1), *triangle);
   af_middle_ = new Node(*triangle->GetPoint(0), *triangle);
@@ -141,6 +959,107 @@ void SweepContext::CreateAdvancingFront()
   af_tail_->prev = af_middle_;
 }
 
+std::vector<size_t> SweepContext::ClusterPoints()
+{
+  const size_t n = points_.size();
+  std::vector<size_t> ranges(polyline_starts_);
+  ranges.push_back(n);
+  const size_t count = polyline_starts_.size();
+
+  // Union-find of the polylines, holes and Steiner points
+  std::vector<size_t> parent(count);
+  for (size_t k = 0; k < count; k++) {
+    parent[k] = k;
+  }
+  const auto find = [&parent](size_t k) {
+    while (parent[k] != k) {
+      parent[k] = parent[parent[k]];
+      k = parent[k];
+    }
+    return k;
+  };
+
+  struct Box {
+    Scalar xmin, ymin, xmax, ymax;
+    size_t root;
+  };
+  std::vector<Box> boxes;
+  boxes.reserve(count);
+  for (size_t k = 0; k < count; k++) {
+    if (ranges[k] == ranges[k + 1]) {
+      continue;
+    }
+    const Point& first = *points_[ranges[k]];
+    Box box{ first.x, first.y, first.x, first.y, k };
+    for (size_t i = ranges[k] + 1; i < ranges[k + 1]; i++) {
+      const Point& point = *points_[i];
+      box.xmin = std::min(box.xmin, point.x);
+      box.xmax = std::max(box.xmax, point.x);
+      box.ymin = std::min(box.ymin, point.y);
+      box.ymax = std::max(box.ymax, point.y);
+    }
+    boxes.push_back(box);
+  }
+  // Merge overlapping boxes, sweeping them from left to right, until a sweep merges none. A
+  // merged box can grow into ones already swept past.
+  bool merged = true;
+  while (merged && boxes.size() > 1) {
+    merged = false;
+    std::sort(boxes.begin(), boxes.end(),
+              [](const Box& a, const Box& b) { return a.xmin < b.xmin; });
+    std::vector<Box> kept;
+    std::vector<size_t> active;
+    for (const Box& box : boxes) {
+      active.erase(std::remove_if(active.begin(), active.end(),
+                                  [&kept, &box](size_t k) { return kept[k].xmax < box.xmin; }),
+                   active.end());
+      bool absorbed = false;
+      for (size_t k : active) {
+        Box& other = kept[k];
+        if (box.ymin <= other.ymax && other.ymin <= box.ymax) {
+          other.xmax = std::max(other.xmax, box.xmax);
+          other.ymin = std::min(other.ymin, box.ymin);
+          other.ymax = std::max(other.ymax, box.ymax);
+          parent[find(box.root)] = find(other.root);
+          absorbed = merged = true;
+          break;
+        }
+      }
+      if (!absorbed) {
+        active.push_back(kept.size());
+        kept.push_back(box);
+      }
+    }
+    boxes.swap(kept);
+  }
+
+  // Copy the points cluster by cluster, numbered by their first polyline
+  std::vector<size_t> cluster(count), sizes, number(count, SIZE_MAX);
+  for (size_t k = 0; k < count; k++) {
+    const size_t root = find(k);
+    if (number[root] == SIZE_MAX) {
+      number[root] = sizes.size();
+      sizes.push_back(0);
+    }
+    cluster[k] = number[root];
+    sizes[cluster[k]] += ranges[k + 1] - ranges[k];
+  }
+  std::vector<size_t> starts{ 0 };
+  for (size_t size : sizes) {
+    starts.push_back(starts.back() + size);
+  }
+  std::vector<size_t> next(starts.begin(), starts.end() - 1);
+  std::vector<Point*> clustered(n);
+  for (size_t k = 0; k < count; k++) {
+    std::copy(points_.begin() + ranges[k], points_.begin() + ranges[k + 1],
+              clustered.begin() + next[cluster[k]]);
+    next[cluster[k]] += ranges[k + 1] - ranges[k];
+  }
+  points_.swap(clustered);
+  polyline_starts_.clear();
+  return starts;
+}
+
 void SweepContext::RemoveNode(Node* node)
 {
   delete node;
@@ -159,10 +1078,22 @@ void SweepContext::MapTriangleToNodes(Triangle& t)
 
 void SweepContext::RemoveFromMap(Triangle* triangle)
 {
-  map_.remove(triangle);
+  Triangle* last = map_.back();
+  map_[triangle->map_index_] = last;
+  last->map_index_ = triangle->map_index_;
+  map_.pop_back();
+}
+
+void SweepContext::IndexPoints()
+{
+  point_index_.clear();
+  point_index_.reserve(points_.size());
+  for (size_t i = 0; i < points_.size(); i++) {
+    point_index_.emplace(points_[i], i);
+  }
 }
 
-void SweepContext::MeshClean(Triangle& triangle)
+void SweepContext::MeshClean(Triangle& triangle, TriangleVisitor* visitor)
 {
   std::vector<Triangle *> triangles;
   triangles.push_back(&triangle);
@@ -173,7 +1104,7 @@ void SweepContext::MeshClean(Triangle& triangle)
 
     if (t != nullptr && !t->IsInterior()) {
       t->IsInterior(true);
-      triangles_.push_back(t);
+      Collect(*t, visitor);
       for (int i = 0; i < 3; i++) {
         if (!t->constrained_edge[i])
           triangles.push_back(t->GetNeighbor(i));
@@ -182,13 +1113,290 @@ void SweepContext::MeshClean(Triangle& triangle)
   }
 }
 
+void SweepContext::MeshCleanComponents(Triangle& outside, TriangleVisitor* visitor)
+{
+  // The interior flag marks visited triangles, it is reset for the ones outside of the domain
+  std::vector<std::pair<Triangle*, bool>> seeds{ { &outside, false } };
+  std::vector<Triangle*> triangles, exterior;
+  while (!seeds.empty()) {
+    Triangle* seed = seeds.back().first;
+    const bool inside = seeds.back().second;
+    seeds.pop_back();
+    if (seed->IsInterior()) {
+      continue;
+    }
+    seed->IsInterior(true);
+    triangles.push_back(seed);
+    while (!triangles.empty()) {
+      Triangle* t = triangles.back();
+      triangles.pop_back();
+      if (inside) {
+        Collect(*t, visitor);
+      } else {
+        exterior.push_back(t);
+      }
+      for (int i = 0; i < 3; i++) {
+        Triangle* neighbor = t->GetNeighbor(i);
+        if (!neighbor || neighbor->IsInterior()) {
+          continue;
+        }
+        if (t->constrained_edge[i]) {
+          // Edges lying on top of each other cancel out
+          const Point* p = t->PointCCW(*t->GetPoint(i));
+          const Point* q = t->PointCW(*t->GetPoint(i));
+          seeds.emplace_back(neighbor, edge_multiplicity(p, q) % 2 != 0 ? !inside : inside);
+        } else {
+          neighbor->IsInterior(true);
+          triangles.push_back(neighbor);
+        }
+      }
+    }
+  }
+  for (Triangle* t : exterior) {
+    t->IsInterior(false);
+  }
+}
+
+void SweepContext::Collect(Triangle& triangle, TriangleVisitor* visitor)
+{
+  if (visitor) {
+    const size_t indices[3] = { point_index_.at(triangle.GetPoint(0)),
+                                point_index_.at(triangle.GetPoint(1)),
+                                point_index_.at(triangle.GetPoint(2)) };
+    visitor->Visit(indices, triangle.constrained_edge);
+  } else {
+    triangle.interior_index_ = static_cast<uint32_t>(triangles_.size());
+    triangles_.push_back(&triangle);
+  }
+}
+
+namespace {
+
+/// How often each ring winds around a region, sorted by ring and without zeros
+using Winding = std::vector<std::pair<size_t, int>>;
+
+void AddWinding(Winding& winding, size_t ring, int delta)
+{
+  auto it = std::lower_bound(winding.begin(), winding.end(), std::make_pair(ring, INT_MIN));
+  if (it == winding.end() || it->first != ring) {
+    winding.emplace(it, ring, delta);
+  } else if ((it->second += delta) == 0) {
+    winding.erase(it);
+  }
+}
+
+struct EdgeHash {
+  size_t operator()(const std::pair<const Point*, const Point*>& edge) const
+  {
+    const std::hash<const Point*> hash;
+    return hash(edge.first) * 31 + hash(edge.second);
+  }
+};
+
+} // namespace
+
+void SweepContext::LabelRegions(Triangle& outside, TriangleVisitor* visitor)
+{
+  // Rings along each edge, keyed by the lower address first, with the winding they add when
+  // crossing from left to right of the edge in that direction. And the area of each ring.
+  const std::less<const Point*> lower;
+  std::unordered_map<std::pair<const Point*, const Point*>, Winding, EdgeHash> ring_edges;
+  ring_edges.reserve(edge_list.size());
+  std::vector<double> areas;
+  for (size_t ring = 0; ring < rings_.size(); ring++) {
+    const std::vector<Point*>& points = rings_[ring];
+    double area = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+      const Point* p = points[i];
+      const Point* q = points[i < points.size() - 1 ? i + 1 : 0];
+      if (lower(p, q)) {
+        ring_edges[{ p, q }].emplace_back(ring, -1);
+      } else {
+        ring_edges[{ q, p }].emplace_back(ring, 1);
+      }
+      area += p->x * q->y - q->x * p->y;
+    }
+    areas.push_back(std::abs(area));
+  }
+
+  // A triangle across the edge from p to q of a region that has been flooded. The winding is
+  // only worked out if the triangle hasn't been reached from elsewhere in the meantime.
+  struct Seed {
+    Triangle* triangle;
+    size_t region;
+    const Point* p;
+    const Point* q;
+  };
+  std::vector<Winding> windings;
+  std::vector<Seed> seeds{ { &outside, 0, nullptr, nullptr } };
+  // The interior flag marks visited triangles, it is reset for the regions that are outside
+  std::vector<Triangle*> triangles, unfilled;
+  while (!seeds.empty()) {
+    const Seed seed = seeds.back();
+    seeds.pop_back();
+    if (seed.triangle->IsInterior()) {
+      continue;
+    }
+    Winding winding;
+    if (seed.p) {
+      // The region is left of the edge, this one right of it
+      winding = windings[seed.region];
+      const bool forward = lower(seed.p, seed.q);
+      const auto found = ring_edges.find(forward ? std::make_pair(seed.p, seed.q)
+                                                 : std::make_pair(seed.q, seed.p));
+      if (found != ring_edges.end()) {
+        for (const auto& ring : found->second) {
+          AddWinding(winding, ring.first, forward ? ring.second : -ring.second);
+        }
+      }
+    }
+    int total = 0;
+    size_t label = rings_.size();
+    for (const auto& ring : winding) {
+      total += ring.second;
+      if (label == rings_.size() || areas[ring.first] < areas[label]) {
+        label = ring.first;
+      }
+    }
+    const bool inside = fill_rule_ == FillRule::EvenOdd ? total % 2 != 0 : total != 0;
+    const size_t region = windings.size();
+    windings.push_back(std::move(winding));
+
+    seed.triangle->IsInterior(true);
+    triangles.push_back(seed.triangle);
+    while (!triangles.empty()) {
+      Triangle* t = triangles.back();
+      triangles.pop_back();
+      if (!inside) {
+        unfilled.push_back(t);
+      } else {
+        Collect(*t, visitor);
+        if (!visitor) {
+          labels_.push_back(label);
+        }
+      }
+      for (int i = 0; i < 3; i++) {
+        Triangle* neighbor = t->GetNeighbor(i);
+        if (!neighbor || neighbor->IsInterior()) {
+          continue;
+        }
+        if (t->constrained_edge[i]) {
+          seeds.push_back({ neighbor, region, t->PointCCW(*t->GetPoint(i)),
+                            t->PointCW(*t->GetPoint(i)) });
+        } else {
+          neighbor->IsInterior(true);
+          triangles.push_back(neighbor);
+        }
+      }
+    }
+  }
+  for (Triangle* t : unfilled) {
+    t->IsInterior(false);
+  }
+}
+
+void SweepContext::Compact()
+{
+  if (!compact_triangles_.empty()) {
+    // Already compacted, triangles_ points into compact_triangles_
+    return;
+  }
+  PurgeRemoved();
+  locate_hint_ = nullptr;
+  compact_triangles_.reserve(triangles_.size());
+  std::unordered_map<const Triangle*, Triangle*> moved;
+  moved.reserve(triangles_.size());
+  for (auto t : triangles_) {
+    compact_triangles_.push_back(*t);
+    moved.emplace(t, &compact_triangles_.back());
+  }
+
+  // Neighbors outside of the interior are gone after this, so unlink them
+  for (auto& t : compact_triangles_) {
+    Triangle* neighbors[3];
+    for (int i = 0; i < 3; i++) {
+      auto it = moved.find(t.GetNeighbor(i));
+      neighbors[i] = it != moved.end() ? it->second : nullptr;
+    }
+    t.ClearNeighbors();
+    for (int i = 0; i < 3; i++) {
+      if (neighbors[i]) {
+        t.MarkNeighbor(t.GetPoint((i + 1) % 3), t.GetPoint((i + 2) % 3), neighbors[i]);
+      }
+    }
+  }
+
+  triangles_.clear();
+  triangles_.shrink_to_fit();
+  for (auto& t : compact_triangles_) {
+    triangles_.push_back(&t);
+  }
+
+  for (auto ptr : map_) {
+    delete ptr;
+  }
+  std::vector<Triangle*>().swap(map_);
+
+  for (Point* point : artificial_points_) {
+    delete point;
+  }
+  artificial_points_.clear();
+  delete front_;
+  delete af_head_;
+  delete af_middle_;
+  delete af_tail_;
+  head_ = tail_ = nullptr;
+  front_ = nullptr;
+  af_head_ = af_middle_ = af_tail_ = nullptr;
+
+  for (auto point : points_) {
+    std::vector<Edge*>().swap(point->edge_list);
+  }
+  for (auto& i : edge_list) {
+    delete i;
+  }
+  std::vector<Edge*>().swap(edge_list);
+  std::vector<Point*>().swap(points_);
+  std::unordered_map<const Point*, size_t>().swap(point_index_);
+  std::vector<std::vector<Point*>>().swap(rings_);
+  std::unordered_set<const Point*>().swap(ring_points_);
+}
+
+MemoryUsage SweepContext::GetMemoryUsage() const
+{
+  MemoryUsage usage;
+  usage.triangles = map_.size() * sizeof(Triangle) +
+                    compact_triangles_.capacity() * sizeof(Triangle);
+  usage.map_nodes = map_.capacity() * sizeof(Triangle*);
+  usage.edges = edge_list.capacity() * sizeof(Edge*) + edge_list.size() * sizeof(Edge);
+  for (auto point : points_) {
+    // Dropped points can be gone already
+    if (dropped_points_.empty() || !dropped_points_.count(point)) {
+      usage.edges += point->edge_list.capacity() * sizeof(Edge*);
+    }
+  }
+  usage.points = points_.capacity() * sizeof(Point*) +
+                 dropped_points_.bucket_count() * sizeof(void*) +
+                 dropped_points_.size() * (sizeof(const Point*) + sizeof(void*)) +
+                 point_index_.bucket_count() * sizeof(void*) +
+                 point_index_.size() * (sizeof(std::pair<const Point*, size_t>) + sizeof(void*));
+  usage.points += artificial_points_.capacity() * sizeof(Point*) +
+                  artificial_points_.size() * sizeof(Point);
+  usage.points += intersections_.capacity() * sizeof(Point*) + intersections_.size() * sizeof(Point);
+  usage.points += input_points_.capacity() * sizeof(Point*);
+  usage.points += welds_.capacity() * sizeof(std::pair<Point*, Point*>);
+  usage.output = triangles_.capacity() * sizeof(Triangle*) + labels_.capacity() * sizeof(size_t);
+  return usage;
+}
+
 SweepContext::~SweepContext()
 {
 
     // Clean up memory
 
-    delete head_;
-    delete tail_;
+    for (Point* point : artificial_points_) {
+      delete point;
+    }
     delete front_;
     delete af_head_;
     delete af_middle_;
@@ -201,6 +1409,9 @@ SweepContext::~SweepContext()
     for (auto& i : edge_list) {
       delete i;
     }
+    for (auto point : intersections_) {
+      delete point;
+    }
 }
 
 } // namespace p2t
@@ -31,7 +31,10 @@
 
 #pragma once
 
-#include <list>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <cstddef>
 
@@ -43,10 +46,49 @@ const double kAlpha = 0.3;
 
 struct Point;
 class Triangle;
+class TriangleVisitor;
 struct Node;
 struct Edge;
 class AdvancingFront;
 
+/// Bytes held by a triangulation, by category
+struct MemoryUsage {
+  /// Triangle objects, including exterior ones that are still in the map
+  size_t triangles;
+  /// Pointers of the triangle map
+  size_t map_nodes;
+  /// Advancing front nodes
+  size_t front_nodes;
+  /// Constrained edges, including the per point edge lists
+  size_t edges;
+  /// Internal copy of the point list and the artificial head and tail points
+  size_t points;
+  /// Vector of interior triangles returned by GetTriangles
+  size_t output;
+  /// Temporary buffers of welding, splitting crossings and the monotone fast path. They are
+  /// freed before Triangulate returns, so only a peak has them.
+  size_t scratch;
+
+  MemoryUsage()
+  : triangles(0), map_nodes(0), front_nodes(0), edges(0), points(0), output(0), scratch(0)
+  {
+  }
+
+  size_t Total() const
+  {
+    return triangles + map_nodes + front_nodes + edges + points + output + scratch;
+  }
+};
+
+/// How the rings added with CDT::AddRing decide which regions are inside
+enum class FillRule {
+  /// Inside an odd number of rings
+  EvenOdd,
+  /// The rings wind around the region a nonzero number of times, counterclockwise rings count
+  /// positive and clockwise ones negative
+  NonZero
+};
+
 class SweepContext {
 public:
 
@@ -65,11 +107,92 @@ Point* tail() const;
 
 size_t point_count() const;
 
+/// Number of points in the outer polyline, they come first in the point list. 0 once sorted.
+size_t polyline_size() const;
+
+/// Allow Sweep to skip the sweep for y-monotone polylines without holes or Steiner points
+void set_monotone_fast_path(bool enabled);
+
+bool monotone_fast_path() const;
+
+/// Let Sweep split crossing edges with SplitIntersections before sweeping
+void set_split_intersections(bool enabled);
+
+bool split_intersections() const;
+
+/**
+ * Split the edges where they cross each other, adding the intersection points as new points,
+ * and where a point lies inside of another edge. Edges overlapping each other are merged, the
+ * pieces remember how many edges they lie on.
+ *
+ * A Bentley-Ottmann sweep finds all crossings in O((n + k) log n) for n edges and k crossings.
+ * Only where a crossing had to move off the edges, rounded to integers or onto a point a few
+ * ulps away, the pieces can cross again and another sweep follows. Each one splits pieces at
+ * points that are representable, so that ends.
+ *
+ * @return whether any edge was split
+ */
+bool SplitIntersections();
+
+/// Points created by SplitIntersections, in the order they were added to the point list
+const std::vector<Point*>& intersections() const;
+
+/// Points in the order they were added, followed by the intersections. Never sorted or welded.
+const std::vector<Point*>& input_points() const;
+
+/// Let Sweep weld points with WeldPoints before sweeping, a negative tolerance disables it
+void set_weld_tolerance(double tolerance);
+
+double weld_tolerance() const;
+
+/**
+ * Merge points that are at most weld_tolerance() apart into the one added first, and the edges
+ * between them, using a hash grid. Edges collapsing into a point are removed.
+ *
+ * @return whether any point was merged
+ */
+bool WeldPoints();
+
+/// Each point removed by WeldPoints with the point it was merged into
+const std::vector<std::pair<Point*, Point*>>& welds() const;
+
+/// Whether there is no polyline, so the convex hull of the points gets triangulated
+bool point_cloud() const;
+
+/// Add another outer polyline, the domain is made of several disjoint polygons then
+void AddPolyline(const std::vector<Point*>& polyline);
+
+/// Number of outer polylines
+size_t polyline_count() const;
+
+/// Add a closed ring of constrained edges. Points and edges shared with earlier rings are only
+/// added once.
+void AddRing(const std::vector<Point*>& ring);
+
+/// Whether rings were added, then their regions are labeled instead of filling the convex hull
+bool has_rings() const;
+
+void set_fill_rule(FillRule rule);
+
+FillRule fill_rule() const;
+
 Node* LocateNode(const Point& point);
 
 void RemoveNode(Node* node);
 
-void CreateAdvancingFront();
+/// Start a new advancing front with the triangle of the point at index first and the artificial
+/// points, replacing the previous one
+void CreateAdvancingFront(size_t first = 0);
+
+/**
+ * Group the points into clusters: the polylines, holes and Steiner points whose bounding boxes
+ * overlap, directly or through others. The points are reordered cluster by cluster. Polygons of
+ * different clusters can't share a triangle, so each cluster can be swept on its own. Only
+ * before the points are welded, split or sorted, all of them are one cluster after that.
+ *
+ * @return where each cluster starts in the point list, followed by the number of points
+ */
+std::vector<size_t> ClusterPoints();
 
 /// Try to map a node to all sides of this triangle that don't have a neighbor
 void MapTriangleToNodes(Triangle& t);
@@ -88,10 +211,106 @@ void AddPoint(Point* point);
 
 AdvancingFront* front() const;
 
-void MeshClean(Triangle& triangle);
+void MeshClean(Triangle& triangle, TriangleVisitor* visitor = nullptr);
+
+/**
+ * Like MeshClean for a domain made of several polygons, which aren't connected by unconstrained
+ * edges. Floods from a triangle outside of the domain and crosses the constrained edges too,
+ * every crossing goes into the domain or out of it.
+ *
+ * @param outside - a triangle outside of the domain to start with
+ * @param visitor
+ */
+void MeshCleanComponents(Triangle& outside, TriangleVisitor* visitor = nullptr);
+
+/**
+ * Flood fill like MeshClean, but cross the constrained edges too and count how often the rings
+ * wind around each region on the way. The regions that are inside according to the fill rule
+ * become interior, labeled with the smallest ring around them.
+ *
+ * @param outside - a triangle outside of all rings to start with
+ * @param visitor
+ */
+void LabelRegions(Triangle& outside, TriangleVisitor* visitor = nullptr);
+
+/// Ring of every triangle in GetTriangles after LabelRegions, empty once the triangles changed
+const std::vector<size_t>& labels() const;
+
+/// Remember the position of every point in input order, needed to report vertex indices
+void IndexPoints();
 
 std::vector<Triangle*> &GetTriangles();
-std::list<Triangle*> &GetMap();
+std::vector<Triangle*> &GetMap();
+
+/**
+ * Find the triangle of the map containing the point by walking from the last located triangle
+ * towards it, falls back to searching the interior triangles if the walk leaves the map
+ *
+ * @return nullptr if no interior triangle contains the point
+ */
+Triangle* LocateTriangle(const Point& point);
+
+/// Whether Triangulate has produced interior triangles that can be edited
+bool IsTriangulated() const;
+
+/// Add an interior triangle to the map
+Triangle* AddInteriorTriangle(Point& a, Point& b, Point& c);
+
+/// Turn a triangle of the map into the one with corners a, b and c, keeping its place in the map
+/// and in the interior triangles
+void ReuseTriangle(Triangle& triangle, Point& a, Point& b, Point& c);
+
+/**
+ * Take an interior triangle that is no longer part of the mesh out of it. It stays in the map
+ * until FreeRemovedTriangles, so that the neighbors of the other removed triangles can still
+ * point to it.
+ */
+void RemoveTriangle(Triangle* triangle);
+
+/// Take the triangles given to RemoveTriangle out of the map and delete them. Each one is
+/// swapped with the last triangle of the map and of the interior triangles, so this costs only
+/// as much as the triangles removed.
+void FreeRemovedTriangles();
+
+/// Take the edge between the two points out of the edge list of its upper point, if there is
+/// one. It is deleted the next time the whole edge list is walked.
+void RemoveEdge(const Point* p, const Point* q);
+
+/// Replace the edge between p and q, if there is one, by the edges from p to point and from
+/// point to q
+void SplitEdge(const Point* p, const Point* q, Point& point);
+
+/// Take a vertex out of the point list. Like with RemoveEdge, that only happens the next time
+/// the whole list is walked.
+void DropPoint(Point* point);
+
+/// Add a vertex to the point list, or keep it there if it was dropped
+void RestorePoint(Point* point);
+
+/**
+ * Delete the triangles outside of the domain and unlink them from the interior ones. They
+ * aren't kept valid when the points move.
+ */
+void RemoveExteriorTriangles();
+
+/**
+ * Delete all triangles and the advancing front, so that the points can be swept again after
+ * they moved. The edges are put back in sweep order.
+ */
+void ResetTriangulation();
+
+/**
+ * Move the interior triangles into contiguous storage and free everything that is only
+ * needed while sweeping: the triangle map, the advancing front and the edges
+ */
+void Compact();
+
+/// Estimate the memory held by this context, see MemoryUsage. The advancing front is left to
+/// Sweep::GetFrontMemoryUsage, which also knows the nodes created while sweeping.
+MemoryUsage GetMemoryUsage() const;
+
+/// Bytes of the temporary buffers of the last WeldPoints or SplitIntersections at their largest
+size_t scratch_memory_usage() const;
 
 std::vector<Edge*> edge_list;
 
@@ -133,9 +352,48 @@ private:
 
 friend class Sweep;
 
+/// Delete the edges given to RemoveEdge and take the points given to DropPoint out of points_
+void PurgeRemoved();
+
+/// One sweep of SplitIntersections, sets moved if a crossing had to move off the edges
+bool SplitCrossings(bool& moved);
+
 std::vector<Triangle*> triangles_;
-std::list<Triangle*> map_;
+std::vector<Triangle*> map_;
+// Interior triangles after Compact, triangles_ points into it
+std::vector<Triangle> compact_triangles_;
 std::vector<Point*> points_;
+std::vector<Point*> input_points_;
+size_t polyline_size_;
+bool monotone_fast_path_;
+bool split_intersections_;
+// Owned, triangles still point to them after Compact
+std::vector<Point*> intersections_;
+// How many input edges lie on the pieces of the edges SplitIntersections split, any other edge
+// has one. Crossing a piece only changes between inside and outside if the count is odd.
+std::map<std::pair<const Point*, const Point*>, int> edge_multiplicity_;
+double weld_tolerance_;
+std::vector<std::pair<Point*, Point*>> welds_;
+size_t polyline_count_;
+// Where each polyline, hole and Steiner point starts in points_, until they are sorted
+std::vector<size_t> polyline_starts_;
+std::vector<std::vector<Point*>> rings_;
+// Points of the rings, so that shared ones are only swept once
+std::unordered_set<const Point*> ring_points_;
+FillRule fill_rule_;
+// Parallel to triangles_, only filled by LabelRegions
+std::vector<size_t> labels_;
+// Where LocateTriangle starts walking
+Triangle* locate_hint_;
+// Triangles given to RemoveTriangle, still in map_ and triangles_
+std::vector<Triangle*> removed_triangles_;
+// Points given to DropPoint that are still in points_
+std::unordered_set<const Point*> dropped_points_;
+// Edges given to RemoveEdge that are still in edge_list, with both ends set to null
+size_t removed_edges_;
+// Input order of the points, only filled by IndexPoints
+std::unordered_map<const Point*, size_t> point_index_;
+size_t scratch_memory_usage_;
 
 // Advancing front
 AdvancingFront* front_;
@@ -143,11 +401,20 @@ AdvancingFront* front_;
 Point* head_;
 // tail point used with advancing front
 Point* tail_;
+// Owned, the head and tail points of every cluster
+std::vector<Point*> artificial_points_;
 
 Node *af_head_, *af_middle_, *af_tail_;
 
-void InitTriangulation();
+/// Create artificial head and tail points below the points from first to last, and sort those
+/// points in sweep order. Earlier head and tail points stay for the triangles using them.
+void InitTriangulation(size_t first, size_t last);
 void InitEdges(const std::vector<Point*>& polyline);
+/// Pass an interior triangle to the visitor or add it to the result
+void Collect(Triangle& triangle, TriangleVisitor* visitor);
+/// Key of edge_multiplicity_, the same in both directions
+static std::pair<const Point*, const Point*> MultiplicityKey(const Point* p, const Point* q);
+int edge_multiplicity(const Point* p, const Point* q) const;
 
 };
 
@@ -161,6 +428,91 @@ inline size_t SweepContext::point_count() const
   return points_.size();
 }
 
+inline size_t SweepContext::polyline_size() const
+{
+  return polyline_size_;
+}
+
+inline void SweepContext::set_monotone_fast_path(bool enabled)
+{
+  monotone_fast_path_ = enabled;
+}
+
+inline bool SweepContext::monotone_fast_path() const
+{
+  return monotone_fast_path_;
+}
+
+inline void SweepContext::set_split_intersections(bool enabled)
+{
+  split_intersections_ = enabled;
+}
+
+inline bool SweepContext::split_intersections() const
+{
+  return split_intersections_;
+}
+
+inline const std::vector<Point*>& SweepContext::intersections() const
+{
+  return intersections_;
+}
+
+inline size_t SweepContext::scratch_memory_usage() const
+{
+  return scratch_memory_usage_;
+}
+
+inline const std::vector<Point*>& SweepContext::input_points() const
+{
+  return input_points_;
+}
+
+inline void SweepContext::set_weld_tolerance(double tolerance)
+{
+  weld_tolerance_ = tolerance;
+}
+
+inline double SweepContext::weld_tolerance() const
+{
+  return weld_tolerance_;
+}
+
+inline const std::vector<std::pair<Point*, Point*>>& SweepContext::welds() const
+{
+  return welds_;
+}
+
+inline bool SweepContext::point_cloud() const
+{
+  return polyline_count_ == 0;
+}
+
+inline size_t SweepContext::polyline_count() const
+{
+  return polyline_count_;
+}
+
+inline bool SweepContext::has_rings() const
+{
+  return !rings_.empty();
+}
+
+inline void SweepContext::set_fill_rule(FillRule rule)
+{
+  fill_rule_ = rule;
+}
+
+inline FillRule SweepContext::fill_rule() const
+{
+  return fill_rule_;
+}
+
+inline const std::vector<size_t>& SweepContext::labels() const
+{
+  return labels_;
+}
+
 inline void SweepContext::set_head(Point* p1)
 {
   head_ = p1;
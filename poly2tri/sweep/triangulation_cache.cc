@@ -0,0 +1,353 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "triangulation_cache.h"
+
+#include "cdt.h"
+#include "../common/utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+namespace p2t {
+
+namespace {
+
+/// Normalized coordinates are rounded to this many steps per unit before comparing
+const double kQuantization = 1 << 26;
+
+/// Collects the triangles of a CDT as indices
+class IndexCollector : public TriangleVisitor {
+public:
+  explicit IndexCollector(std::vector<size_t>& triangles) : triangles_(triangles)
+  {
+  }
+
+  void Visit(const size_t indices[3], const bool[3]) override
+  {
+    triangles_.insert(triangles_.end(), indices, indices + 3);
+  }
+
+private:
+  std::vector<size_t>& triangles_;
+};
+
+const size_t kNoNeighbor = static_cast<size_t>(-1);
+
+struct EdgeHash {
+  size_t operator()(const std::pair<size_t, size_t>& edge) const
+  {
+    return std::hash<size_t>()(edge.first) * 31 + edge.second;
+  }
+};
+
+/// Entry::neighbors of counter-clockwise triangles
+std::vector<size_t> Neighbors(const std::vector<size_t>& triangles)
+{
+  // Directed edge to the corner opposite of it
+  std::unordered_map<std::pair<size_t, size_t>, size_t, EdgeHash> corners;
+  corners.reserve(triangles.size());
+  for (size_t corner = 0; corner < triangles.size(); corner++) {
+    const size_t t = corner - corner % 3;
+    const size_t b = triangles[t + (corner + 1) % 3], c = triangles[t + (corner + 2) % 3];
+    corners.emplace(std::make_pair(b, c), corner);
+  }
+  std::vector<size_t> neighbors(triangles.size(), kNoNeighbor);
+  for (const auto& edge : corners) {
+    const auto other = corners.find(std::make_pair(edge.first.second, edge.first.first));
+    if (other != corners.end()) {
+      neighbors[edge.second] = other->second / 3;
+    }
+  }
+  return neighbors;
+}
+
+/// Corner of triangle u that isn't b or c
+size_t OppositeCorner(const std::vector<size_t>& triangles, size_t u, size_t b, size_t c)
+{
+  for (size_t corner = 3 * u; corner < 3 * u + 3; corner++) {
+    if (triangles[corner] != b && triangles[corner] != c) {
+      return corner;
+    }
+  }
+  return kNoNeighbor;
+}
+
+/**
+ * Whether d lies inside the circumcircle of the counter-clockwise triangle a, b, c for sure.
+ * Either diagonal of cocircular points is Delaunay, so points on the circle, or too close to it
+ * to tell, aren't.
+ */
+bool StrictlyInCircumcircle(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+{
+#ifdef P2T_INTEGER_COORDINATES
+  return IntegerIncircle(pa, pb, pc, pd) > 0;
+#else
+  Real permanent;
+  const Real det = IncircleDeterminant(pa, pb, pc, pd, permanent);
+  return det > IncircleErrorBound() * permanent;
+#endif
+}
+
+/// Whether the edge opposite the corner isn't locally Delaunay for the points
+bool Illegal(const std::vector<const Point*>& points, const std::vector<size_t>& triangles,
+             const std::vector<size_t>& neighbors, size_t corner)
+{
+  const size_t u = neighbors[corner];
+  if (u == kNoNeighbor) {
+    return false;
+  }
+  const size_t t = corner - corner % 3;
+  const size_t a = triangles[corner];
+  const size_t b = triangles[t + (corner + 1) % 3];
+  const size_t c = triangles[t + (corner + 2) % 3];
+  const size_t d = triangles[OppositeCorner(triangles, u, b, c)];
+  return StrictlyInCircumcircle(*points[a], *points[b], *points[c], *points[d]);
+}
+
+/// Replace the triangles on both sides of the edge opposite the corner by the ones on the other
+/// diagonal. Returns the corners opposite of the four outer edges.
+std::array<size_t, 4> Flip(std::vector<size_t>& triangles, std::vector<size_t>& neighbors,
+                           size_t corner)
+{
+  const size_t t = corner / 3, i = corner % 3;
+  const size_t u = neighbors[corner];
+  const size_t a = triangles[corner];
+  const size_t p1 = triangles[3 * t + (i + 1) % 3];
+  const size_t p2 = triangles[3 * t + (i + 2) % 3];
+  const size_t j = OppositeCorner(triangles, u, p1, p2) % 3;
+  const size_t d = triangles[3 * u + j];
+  // Across p2 to a, a to p1, p1 to d and d to p2
+  const size_t outer[4] = { neighbors[3 * t + (i + 1) % 3], neighbors[3 * t + (i + 2) % 3],
+                            neighbors[3 * u + (j + 1) % 3], neighbors[3 * u + (j + 2) % 3] };
+  const auto relink = [&neighbors](size_t triangle, size_t from, size_t to) {
+    if (triangle != kNoNeighbor) {
+      for (size_t k = 3 * triangle; k < 3 * triangle + 3; k++) {
+        if (neighbors[k] == from) {
+          neighbors[k] = to;
+        }
+      }
+    }
+  };
+  relink(outer[0], t, u);
+  relink(outer[2], u, t);
+  // t becomes a, p1, d and u becomes a, d, p2, both counter-clockwise
+  const size_t t_corners[3] = { a, p1, d }, t_neighbors[3] = { outer[2], u, outer[1] };
+  const size_t u_corners[3] = { a, d, p2 }, u_neighbors[3] = { outer[3], outer[0], t };
+  for (size_t k = 0; k < 3; k++) {
+    triangles[3 * t + k] = t_corners[k];
+    neighbors[3 * t + k] = t_neighbors[k];
+    triangles[3 * u + k] = u_corners[k];
+    neighbors[3 * u + k] = u_neighbors[k];
+  }
+  return { { 3 * t, 3 * t + 2, 3 * u, 3 * u + 1 } };
+}
+
+/**
+ * Flip the edges that aren't locally Delaunay until none is left. An edge only stops being
+ * locally Delaunay when a triangle next to it is flipped, so the edges opposite corners before
+ * the first one, known to be fine, aren't tested again unless they are.
+ */
+void Legalize(const std::vector<const Point*>& points, std::vector<size_t>& triangles,
+              std::vector<size_t>& neighbors, size_t first, std::vector<size_t>& work)
+{
+  work.clear();
+  for (size_t corner = first; corner < triangles.size(); corner++) {
+    if (neighbors[corner] != kNoNeighbor && neighbors[corner] > corner / 3) {
+      work.push_back(corner);
+    }
+  }
+  while (!work.empty()) {
+    const size_t corner = work.back();
+    work.pop_back();
+    if (Illegal(points, triangles, neighbors, corner)) {
+      const std::array<size_t, 4> outer = Flip(triangles, neighbors, corner);
+      work.insert(work.end(), outer.begin(), outer.end());
+    }
+  }
+}
+
+} // namespace
+
+TriangulationCache::TriangulationCache(size_t capacity) : capacity_(capacity)
+{
+}
+
+const std::vector<size_t>& TriangulationCache::Triangulate(
+  const std::vector<Point*>& polyline, const std::vector<std::vector<Point*>>& holes)
+{
+  std::vector<const Point*> points(polyline.begin(), polyline.end());
+  for (const auto& hole : holes) {
+    points.insert(points.end(), hole.begin(), hole.end());
+  }
+  if (points.empty()) {
+    throw std::runtime_error("TriangulationCache::Triangulate - empty polyline");
+  }
+
+  // Canonical frame: the bounding box moved to the origin and scaled to a unit square
+  Scalar xmin = points[0]->x, xmax = xmin, ymin = points[0]->y, ymax = ymin;
+  for (const Point* point : points) {
+    xmin = std::min(xmin, point->x);
+    xmax = std::max(xmax, point->x);
+    ymin = std::min(ymin, point->y);
+    ymax = std::max(ymax, point->y);
+  }
+  // Differences are taken in double, in float they would round before being quantized
+  const double extent =
+    std::max(static_cast<double>(xmax) - xmin, static_cast<double>(ymax) - ymin);
+  const double scale = extent > 0 ? kQuantization / extent : 0;
+
+  std::vector<int64_t> key;
+  key.reserve(2 + holes.size() + 2 * points.size());
+  key.push_back(static_cast<int64_t>(holes.size()));
+  key.push_back(static_cast<int64_t>(polyline.size()));
+  for (const auto& hole : holes) {
+    key.push_back(static_cast<int64_t>(hole.size()));
+  }
+  for (const Point* point : points) {
+    key.push_back(std::llround((static_cast<double>(point->x) - xmin) * scale));
+    key.push_back(std::llround((static_cast<double>(point->y) - ymin) * scale));
+  }
+  size_t hash = key.size();
+  for (const int64_t value : key) {
+    hash ^= std::hash<int64_t>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+  }
+
+  const auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const auto entry = it->second;
+    if (entry->key != key) {
+      continue;
+    }
+    const std::vector<size_t>& triangles = entry->triangles;
+    bool valid = true;
+    for (size_t i = 0; i < triangles.size() && valid; i += 3) {
+      valid = Orient2d(*points[triangles[i]], *points[triangles[i + 1]],
+                       *points[triangles[i + 2]]) == CCW;
+    }
+    if (valid) {
+      statistics_.hits++;
+      entries_.splice(entries_.begin(), entries_, entry);
+      const std::vector<size_t>& neighbors = entry->neighbors;
+      for (size_t corner = 0; corner < triangles.size(); corner++) {
+        if (neighbors[corner] > corner / 3 && Illegal(points, triangles, neighbors, corner)) {
+          // Rounding made a difference, flip the edges into place
+          statistics_.repairs++;
+          repaired_ = triangles;
+          repaired_neighbors_ = neighbors;
+          Legalize(points, repaired_, repaired_neighbors_, corner, work_);
+          return repaired_;
+        }
+      }
+      return triangles;
+    }
+    // Close to degenerate, rounding made a difference. Triangulated again below.
+    entries_.erase(entry);
+    index_.erase(it);
+    break;
+  }
+
+  // Triangulate copies, CDT adds edges to the points
+  statistics_.misses++;
+  std::vector<Point> copies;
+  copies.reserve(points.size());
+  for (const Point* point : points) {
+    copies.emplace_back(point->x, point->y);
+  }
+  std::vector<Point*> copy_polyline;
+  for (size_t i = 0; i < polyline.size(); i++) {
+    copy_polyline.push_back(&copies[i]);
+  }
+  std::vector<size_t> triangles;
+  {
+    CDT cdt(copy_polyline);
+    size_t offset = polyline.size();
+    for (const auto& hole : holes) {
+      std::vector<Point*> copy_hole;
+      for (size_t i = 0; i < hole.size(); i++) {
+        copy_hole.push_back(&copies[offset + i]);
+      }
+      offset += hole.size();
+      cdt.AddHole(copy_hole);
+    }
+    IndexCollector collector(triangles);
+    cdt.Triangulate(collector);
+  }
+  // The sweep can leave edges that aren't locally Delaunay after inserting constraints
+  std::vector<size_t> neighbors = Neighbors(triangles);
+  Legalize(points, triangles, neighbors, 0, work_);
+
+  if (capacity_ == 0) {
+    uncached_ = std::move(triangles);
+    return uncached_;
+  }
+  if (entries_.size() >= capacity_) {
+    const auto last = std::prev(entries_.end());
+    const auto evicted = index_.equal_range(last->hash);
+    for (auto it = evicted.first; it != evicted.second; ++it) {
+      if (it->second == last) {
+        index_.erase(it);
+        break;
+      }
+    }
+    entries_.erase(last);
+    statistics_.evictions++;
+  }
+  entries_.push_front(Entry{ hash, std::move(key), std::move(triangles), std::move(neighbors) });
+  index_.emplace(hash, entries_.begin());
+  return entries_.front().triangles;
+}
+
+CacheStatistics TriangulationCache::GetStatistics() const
+{
+  return statistics_;
+}
+
+size_t TriangulationCache::size() const
+{
+  return entries_.size();
+}
+
+size_t TriangulationCache::capacity() const
+{
+  return capacity_;
+}
+
+void TriangulationCache::Clear()
+{
+  entries_.clear();
+  index_.clear();
+}
+
+} // namespace p2t
@@ -0,0 +1,133 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2022, Poly2Tri Contributors
+ * https://github.com/jhasse/poly2tri
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../common/dll_symbol.h"
+#include "../common/shapes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace p2t {
+
+/// Lookup counts of a TriangulationCache
+struct CacheStatistics {
+  /// Triangulations taken from the cache
+  size_t hits;
+  /// Hits whose triangulation needed edge flips to be Delaunay for the actual points
+  size_t repairs;
+  /// Triangulations that had to be computed
+  size_t misses;
+  /// Entries dropped because the cache was full
+  size_t evictions;
+
+  CacheStatistics() : hits(0), repairs(0), misses(0), evictions(0)
+  {
+  }
+};
+
+/**
+ * Remembers the triangulations of the polygons seen last, for inputs that contain the same
+ * shapes over and over (icons, glyphs, building templates).
+ *
+ * New triangulations come from CDT, with the edges flipped where a point lies inside the
+ * circumcircle of the triangle across, which the sweep can leave behind after inserting
+ * constraints. The result is constrained Delaunay, and the same for every polygon with points in
+ * general position whether it was cached or not. Cocircular points can take either diagonal.
+ *
+ * Polygons are compared after moving and scaling their bounding box to the unit square, so
+ * copies that only differ by translation and uniform scale share an entry. Such a similarity
+ * transformation keeps the triangulation constrained Delaunay. The points have to come in the
+ * same order. Normalized coordinates are rounded to find an entry, so a cached triangulation
+ * is checked against the actual points before it is used: all triangles have to keep their
+ * orientation, and edges that rounding moved out of the Delaunay condition are flipped again.
+ */
+class P2T_DLL_SYMBOL TriangulationCache {
+public:
+  /**
+   * @param capacity - number of triangulations to keep, the least recently used one is dropped
+   *                   first
+   */
+  explicit TriangulationCache(size_t capacity);
+
+  /**
+   * Triangulate a polygon with holes like CDT, or take the triangulation from the cache.
+   * The points aren't modified.
+   *
+   * @param polyline
+   * @param holes
+   * @return three indices per triangle, counter-clockwise. Points are counted like for
+   *         TriangleVisitor: the polyline first, then the holes in order. Stays valid until the
+   *         next call.
+   */
+  const std::vector<size_t>& Triangulate(const std::vector<Point*>& polyline,
+                                         const std::vector<std::vector<Point*>>& holes = {});
+
+  CacheStatistics GetStatistics() const;
+
+  /// Number of triangulations in the cache
+  size_t size() const;
+
+  size_t capacity() const;
+
+  /// Drop all triangulations, the statistics are kept
+  void Clear();
+
+private:
+
+  struct Entry {
+    size_t hash;
+    /// Number of holes, ring sizes, then the quantized normalized coordinates
+    std::vector<int64_t> key;
+    std::vector<size_t> triangles;
+    /// Triangle across the edge opposite each corner, none on the border
+    std::vector<size_t> neighbors;
+  };
+
+  size_t capacity_;
+  CacheStatistics statistics_;
+  /// Most recently used first
+  std::list<Entry> entries_;
+  std::unordered_multimap<size_t, std::list<Entry>::iterator> index_;
+  /// Result of the last call if the capacity is 0
+  std::vector<size_t> uncached_;
+  /// Result of the last hit that needed flips, and its Entry::neighbors
+  std::vector<size_t> repaired_;
+  std::vector<size_t> repaired_neighbors_;
+  /// Edges left to test while flipping
+  std::vector<size_t> work_;
+};
+
+}
@@ -37,13 +37,10 @@
 #include <cstdlib>
 #include <ctime>
 #include <exception>
-#include <fstream>
 #include <iostream>
-#include <iterator>
 #include <limits>
 #include <list>
 #include <numeric>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -64,7 +61,6 @@ void MainLoop(const double zoom);
 void Draw(const double zoom);
 void DrawMap(const double zoom);
 void ConstrainedColor(bool constrain);
-double StringToDouble(const std::string& s);
 double Random(double (*fun)(double), double xmin, double xmax);
 double Fun(double x);
 
@@ -235,60 +231,19 @@ int main(int argc, char* argv[])
 bool ParseFile(string filename, vector<Point*>& out_polyline, vector<vector<Point*>>& out_holes,
                vector<Point*>& out_steiner)
 {
-  enum ParserState {
-    Polyline,
-    Hole,
-    Steiner,
-  };
-  ParserState state = Polyline;
-  vector<Point*>* hole = nullptr;
   try {
-    string line;
-    ifstream myfile(filename);
-    if (myfile.is_open()) {
-      while (!myfile.eof()) {
-        getline(myfile, line);
-        if (line.empty()) {
-          break;
-        }
-        istringstream iss(line);
-        vector<string> tokens;
-        copy(istream_iterator<string>(iss), istream_iterator<string>(), back_inserter(tokens));
-        if (tokens.empty()) {
-          break;
-        } else if (tokens.size() == 1u) {
-          const auto token = tokens[0];
-          if (token == "HOLE") {
-            state = Hole;
-            out_holes.emplace_back();
-            hole = &out_holes.back();
-          } else if (token == "STEINER") {
-            state = Steiner;
-          } else {
-            throw runtime_error("Invalid token [" + token + "]");
-          }
-        } else {
-          double x = StringToDouble(tokens[0]);
-          double y = StringToDouble(tokens[1]);
-          switch (state) {
-            case Polyline:
-              out_polyline.push_back(new Point(x, y));
-              break;
-            case Hole:
-              assert(hole != nullptr);
-              hole->push_back(new Point(x, y));
-              break;
-            case Steiner:
-              out_steiner.push_back(new Point(x, y));
-              break;
-            default:
-              assert(0);
-          }
-        }
+    const DatFile file(filename);
+    const auto copy = [](const vector<Point*>& points, vector<Point*>& out) {
+      for (const Point* point : points) {
+        out.push_back(new Point(point->x, point->y));
       }
-    } else {
-      throw runtime_error("File not opened");
+    };
+    copy(file.polyline(), out_polyline);
+    for (const vector<Point*>& hole : file.holes()) {
+      out_holes.emplace_back();
+      copy(hole, out_holes.back());
     }
+    copy(file.steiner(), out_steiner);
   } catch (exception& e) {
     cerr << "Error parsing file: " << e.what() << endl;
     return false;
@@ -500,15 +455,6 @@ void ConstrainedColor(bool constrain)
   }
 }
 
-double StringToDouble(const std::string& s)
-{
-  std::istringstream i(s);
-  double x;
-  if (!(i >> x))
-    return 0;
-  return x;
-}
-
 double Fun(double x)
 {
   return 2.5 + sin(10 * x) / x;
@@ -4,14 +4,35 @@
 #define BOOST_TEST_MODULE Poly2triTest
 
 #include <poly2tri/poly2tri.h>
+#include <poly2tri/common/utils.h>
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <set>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+/// Tolerance in percent for areas and lengths summed up from p2t::Scalar coordinates
+const double kTolerance =
+  std::max(1e-9, 1e4 * static_cast<double>(std::numeric_limits<p2t::Scalar>::epsilon()));
+
+} // namespace
 
 BOOST_AUTO_TEST_CASE(BasicTest)
 {
@@ -261,3 +282,1909 @@ BOOST_AUTO_TEST_CASE(TestbedFilesTest)
     }
   }
 }
+
+// The inputs of the tests above scaled to integer coordinates, so that they run with
+// P2T_INTEGER_COORDINATES too
+
+BOOST_AUTO_TEST_CASE(NarrowQuadIntegerTest)
+{
+  std::vector<p2t::Point> points{ { 0, 0 }, { 100, 0 }, { 1100, 3 }, { 1000, 3 } };
+  std::vector<p2t::Point*> polyline{ &points[0], &points[1], &points[2], &points[3] };
+  p2t::CDT cdt{ polyline };
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+  const auto result = cdt.GetTriangles();
+  BOOST_REQUIRE_EQUAL(result.size(), 2);
+  BOOST_CHECK(p2t::IsDelaunay(result));
+}
+
+BOOST_AUTO_TEST_CASE(ConcaveBoundaryIntegerTest)
+{
+  // Concave by a single unit
+  std::vector<p2t::Point> points{ { 0, 0 },          { 500000, 1 },       { 1000000, 0 },
+                                  { 999999, 836541 }, { 1000000, 2000000 }, { 460000, 1460001 },
+                                  { 0, 1000000 },     { 1, 500000 } };
+  std::vector<p2t::Point> hole{ { 853553, 500000 },
+                                { 500000, 853553 },
+                                { 146447, 500000 },
+                                { 499999, 146447 } };
+  std::vector<p2t::Point> interior_points{ { 210000, 790000 },
+                                           { 210000, 210000 },
+                                           { 790000, 210000 } };
+  const auto pointers = [](std::vector<p2t::Point>& points) {
+    std::vector<p2t::Point*> polyline;
+    for (p2t::Point& point : points) {
+      polyline.push_back(&point);
+    }
+    return polyline;
+  };
+  p2t::CDT cdt{ pointers(points) };
+  cdt.AddHole(pointers(hole));
+  for (p2t::Point& point : interior_points) {
+    cdt.AddPoint(&point);
+  }
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+  const auto result = cdt.GetTriangles();
+  BOOST_REQUIRE_EQUAL(result.size(), 18);
+  BOOST_CHECK(p2t::IsDelaunay(result));
+}
+
+BOOST_AUTO_TEST_CASE(PolygonIntegerTest)
+{
+  // PolygonTest01 to 03 scaled by 2^27, where vertices that differed in the last bits coincide
+  const std::vector<std::pair<std::vector<double>, size_t>> polygons{
+    { { -0.388419120000000006598384061363, 0.0368141516905975269002837535481,
+        -0.388419120000000006598384061363, 0.0104235565411950892311665484158,
+        -0.611580879999999993401615938637, 0.0104235565411950892311665484158,
+        -0.611580879999999993401615938637, 0.1483950316905975341796875,
+        -0.578899596898762469621146919962, 0.227294628589359948289683188705,
+        -0.500000000000000000000000000000, 0.259975911690597527581303438637,
+        +0.500000000000000000000000000000, 0.259975911690597527581303438637,
+        +0.578899596898762469621146919962, 0.227294628589359948289683188705,
+        +0.611580879999999993401615938637, 0.1483950316905975341796875,
+        +0.611580879999999993401615938637, 0.0104235565411950614755909327869,
+        +0.388419120000000006598384061363, 0.0104235565411950892311665484158,
+        +0.388419120000000006598384061363, 0.0368141516905975130224959457337 },
+      10 },
+    { { 0.9636984967276516,   0.7676550649687783,  0.9636984967276516,   -0.7676550649687641,
+        -0.3074475690811459,  -0.7676550649687641, 0.09401654924378076,  -0.2590574983578904,
+        0.10567230819363671,  -0.09864698028880525, -0.03901177977841874, -0.028405214140875046,
+        -0.428964921810446,   -0.08483619470406722, -0.5128305980156834, -0.12847817634298053,
+        -0.5512747518916774,  -0.2148501697175078, -0.5917836778064418,  -0.7037530067555622,
+        -0.5520451065921502,  -0.7676550649687641, -0.9636984967276516,  -0.7676550649687641,
+        -0.9636984967276516,  0.767655064968778 },
+      11 },
+    { { 0.9776422201600001, 0.9776422201599928, 0.9776422201599999, -0.977642220160007,
+        -0.12788518519240472, -0.9776422201599928, -0.3913394510746002, -0.33861494064331055,
+        -0.47812835166211676, -0.9776422201599928, -0.9776422201600001, -0.9776422201599928,
+        -0.9776422201600001, 0.977642220160007 },
+      5 },
+  };
+  for (const auto& polygon : polygons) {
+    std::vector<p2t::Point> points;
+    for (size_t i = 0; i < polygon.first.size(); i += 2) {
+      points.emplace_back(std::round(polygon.first[i] * (1 << 27)),
+                          std::round(polygon.first[i + 1] * (1 << 27)));
+    }
+    std::vector<p2t::Point*> polyline;
+    for (p2t::Point& point : points) {
+      polyline.push_back(&point);
+    }
+    p2t::CDT cdt{ polyline };
+    BOOST_CHECK_NO_THROW(cdt.Triangulate());
+    BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), polygon.second);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestbedFilesIntegerTest)
+{
+#ifndef P2T_BASE_DIR
+  const auto basedir = boost::filesystem::path(__FILE__).remove_filename().parent_path();
+#else
+  const auto basedir = boost::filesystem::path(P2T_BASE_DIR);
+#endif
+  for (const auto& filename : { "custom.dat", "diamond.dat", "star.dat", "test.dat" }) {
+    const p2t::DatFile file((basedir / "testbed/data" / filename).string());
+    // Five decimals are enough for test.dat
+    std::vector<p2t::Point> points;
+    for (const p2t::Point& point : file.points()) {
+      points.emplace_back(std::round(point.x * 1e5), std::round(point.y * 1e5));
+    }
+    std::vector<p2t::Point*> polyline;
+    for (p2t::Point& point : points) {
+      polyline.push_back(&point);
+    }
+    p2t::CDT cdt{ polyline };
+    BOOST_CHECK_NO_THROW(cdt.Triangulate());
+    const auto result = cdt.GetTriangles();
+    BOOST_REQUIRE(result.size() * 3 > polyline.size());
+    BOOST_CHECK_MESSAGE(p2t::IsDelaunay(result), filename + std::to_string(polyline.size()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(VisitorTest)
+{
+  std::vector<p2t::Point*> polyline {
+    new p2t::Point(450, 2250),
+    new p2t::Point(450, 1750),
+    new p2t::Point(400, 1700),
+    new p2t::Point(350, 1650),
+    new p2t::Point(350, 500),
+    new p2t::Point(1050, 1700)
+  };
+  std::vector<p2t::Point*> hole {
+    new p2t::Point(980, 1636),
+    new p2t::Point(950, 1600),
+    new p2t::Point(650, 1230),
+    new p2t::Point(625, 1247),
+    new p2t::Point(600, 1250),
+    new p2t::Point(591, 1350),
+    new p2t::Point(550, 2050)
+  };
+  p2t::Point steiner(500, 1000);
+  std::vector<p2t::Point*> points = polyline;
+  points.insert(points.end(), hole.begin(), hole.end());
+  points.push_back(&steiner);
+
+  struct Collector : p2t::TriangleVisitor {
+    std::vector<std::array<size_t, 3>> triangles;
+    size_t constrained = 0;
+    void Visit(const size_t indices[3], const bool constrained_edge[3]) override
+    {
+      triangles.push_back({ { indices[0], indices[1], indices[2] } });
+      constrained += constrained_edge[0] + constrained_edge[1] + constrained_edge[2];
+    }
+  } collector;
+
+  p2t::CDT streamed{ polyline };
+  streamed.AddHole(hole);
+  streamed.AddPoint(&steiner);
+  BOOST_CHECK_NO_THROW(streamed.Triangulate(collector));
+  BOOST_CHECK(streamed.GetTriangles().empty());
+
+  // A CDT adds its edges to the points, so the second one gets copies
+  const auto copy = [](const std::vector<p2t::Point*>& points) {
+    std::vector<p2t::Point*> result;
+    for (const auto p : points) {
+      result.push_back(new p2t::Point(p->x, p->y));
+    }
+    return result;
+  };
+  const std::vector<p2t::Point*> polyline_copy = copy(polyline);
+  const std::vector<p2t::Point*> hole_copy = copy(hole);
+  p2t::Point steiner_copy(steiner.x, steiner.y);
+  p2t::CDT collected{ polyline_copy };
+  collected.AddHole(hole_copy);
+  collected.AddPoint(&steiner_copy);
+  BOOST_CHECK_NO_THROW(collected.Triangulate());
+  const auto result = collected.GetTriangles();
+  BOOST_REQUIRE_EQUAL(collector.triangles.size(), result.size());
+  size_t constrained = 0;
+  for (size_t i = 0; i < result.size(); ++i) {
+    for (int j = 0; j < 3; ++j) {
+      BOOST_CHECK_EQUAL(*points[collector.triangles[i][j]], *result[i]->GetPoint(j));
+      constrained += result[i]->constrained_edge[j];
+    }
+  }
+  BOOST_CHECK_EQUAL(collector.constrained, constrained);
+  for (const auto& owned : { polyline, hole, polyline_copy, hole_copy }) {
+    for (const auto p : owned) {
+      delete p;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CompactTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4, 0),
+                                     new p2t::Point(4, 4), new p2t::Point(0, 4) };
+  std::vector<p2t::Point*> hole{ new p2t::Point(1, 1), new p2t::Point(1, 2),
+                                 new p2t::Point(2, 2), new p2t::Point(2, 1) };
+  p2t::Point steiner(3, 3);
+  p2t::CDT cdt{ polyline };
+  cdt.AddHole(hole);
+  cdt.AddPoint(&steiner);
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+
+  std::vector<std::array<p2t::Point*, 3>> before;
+  size_t neighbors = 0;
+  for (const auto t : cdt.GetTriangles()) {
+    before.push_back({ { t->GetPoint(0), t->GetPoint(1), t->GetPoint(2) } });
+    for (int i = 0; i < 3; ++i) {
+      neighbors += t->GetNeighbor(i) != nullptr && t->GetNeighbor(i)->IsInterior();
+    }
+  }
+
+  cdt.Compact();
+  BOOST_CHECK(cdt.GetMap().empty());
+  BOOST_CHECK(polyline[0]->edge_list.empty());
+  const auto result = cdt.GetTriangles();
+  BOOST_REQUIRE_EQUAL(result.size(), before.size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    for (int j = 0; j < 3; ++j) {
+      BOOST_CHECK_EQUAL(result[i]->GetPoint(j), before[i][j]);
+      p2t::Triangle* neighbor = result[i]->GetNeighbor(j);
+      if (neighbor) {
+        --neighbors;
+        BOOST_CHECK(std::find(result.begin(), result.end(), neighbor) != result.end());
+        BOOST_CHECK(neighbor->Contains(result[i]->GetPoint((j + 1) % 3),
+                                       result[i]->GetPoint((j + 2) % 3)));
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(neighbors, 0);
+  BOOST_CHECK(p2t::IsDelaunay(result));
+  BOOST_CHECK_THROW(cdt.Triangulate(), std::runtime_error);
+
+  // A second call keeps the compacted triangles where they are
+  cdt.Compact();
+  BOOST_CHECK(cdt.GetTriangles() == result);
+  for (size_t i = 0; i < result.size(); ++i) {
+    for (int j = 0; j < 3; ++j) {
+      BOOST_CHECK_EQUAL(result[i]->GetPoint(j), before[i][j]);
+    }
+  }
+  for (const auto p : polyline) {
+    delete p;
+  }
+  for (const auto p : hole) {
+    delete p;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MemoryUsageTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4, 0),
+                                     new p2t::Point(4, 4), new p2t::Point(0, 4) };
+  std::vector<p2t::Point> steiner{ { 1, 1 }, { 3, 1 }, { 2, 2 }, { 1, 3 }, { 3, 3 } };
+  p2t::CDT cdt{ polyline };
+  for (auto& p : steiner) {
+    cdt.AddPoint(&p);
+  }
+  BOOST_CHECK_EQUAL(cdt.GetPeakMemoryUsage().Total(), 0);
+  const auto initial = cdt.GetMemoryUsage();
+  BOOST_CHECK_EQUAL(initial.triangles, 0);
+  BOOST_CHECK_GE(initial.edges, 4 * sizeof(p2t::Edge));
+  BOOST_CHECK_GE(initial.points, 9 * sizeof(p2t::Point*));
+
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+  const auto usage = cdt.GetMemoryUsage();
+  const auto peak = cdt.GetPeakMemoryUsage();
+  BOOST_CHECK_EQUAL(peak.Total(), usage.Total());
+  BOOST_CHECK_GE(usage.triangles, cdt.GetMap().size() * sizeof(p2t::Triangle));
+  BOOST_CHECK_GE(usage.output, cdt.GetTriangles().size() * sizeof(p2t::Triangle*));
+  BOOST_CHECK_GT(usage.front_nodes, 0);
+  BOOST_CHECK_GT(usage.map_nodes, 0);
+
+  cdt.Compact();
+  const auto compacted = cdt.GetMemoryUsage();
+  BOOST_CHECK_EQUAL(compacted.front_nodes, 0);
+  BOOST_CHECK_EQUAL(compacted.map_nodes, 0);
+  BOOST_CHECK_EQUAL(compacted.edges, 0);
+  BOOST_CHECK_LT(compacted.Total(), usage.Total());
+  BOOST_CHECK_EQUAL(cdt.GetPeakMemoryUsage().Total(), peak.Total());
+
+  // The temporary buffers of the monotone fast path are alive next to the triangles
+  p2t::CDT monotone{ polyline };
+  monotone.SetMonotoneFastPath(true);
+  monotone.Triangulate();
+  BOOST_CHECK_GT(monotone.GetPeakMemoryUsage().scratch, 0);
+  BOOST_CHECK_GT(monotone.GetPeakMemoryUsage().Total(), monotone.GetMemoryUsage().Total());
+  for (const auto p : polyline) {
+    delete p;
+  }
+}
+
+namespace {
+
+std::vector<std::array<p2t::Point*, 3>>
+SortedTriangles(const std::vector<p2t::Triangle*>& triangles)
+{
+  std::vector<std::array<p2t::Point*, 3>> result;
+  for (const auto t : triangles) {
+    std::array<p2t::Point*, 3> points{ { t->GetPoint(0), t->GetPoint(1), t->GetPoint(2) } };
+    std::sort(points.begin(), points.end());
+    result.push_back(points);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MonotoneFastPathTest)
+{
+  // Convex: points on an ellipse
+  std::vector<p2t::Point*> convex;
+  for (const double angle : { 0.1, 0.9, 1.7, 2.2, 3.0, 3.9, 4.6, 5.5 }) {
+    convex.push_back(
+      new p2t::Point(std::round(3000 * std::cos(angle)), std::round(2000 * std::sin(angle))));
+  }
+  // Monotone but not convex
+  std::vector<p2t::Point*> monotone{
+    new p2t::Point(0, 0),    new p2t::Point(12, 11),  new p2t::Point(6, 23),
+    new p2t::Point(17, 32),  new p2t::Point(1, 40),   new p2t::Point(-8, 31),
+    new p2t::Point(-15, 26), new p2t::Point(-4, 14),  new p2t::Point(-11, 7)
+  };
+
+  for (const auto polyline : { &convex, &monotone }) {
+    p2t::CDT fast{ *polyline };
+    fast.SetMonotoneFastPath(true);
+    BOOST_CHECK_NO_THROW(fast.Triangulate());
+    // No artificial points or exterior triangles
+    BOOST_CHECK_EQUAL(fast.GetMap().size(), polyline->size() - 2);
+
+    p2t::CDT swept{ *polyline };
+    swept.SetMonotoneFastPath(false);
+    BOOST_CHECK_NO_THROW(swept.Triangulate());
+    BOOST_CHECK_GT(swept.GetMap().size(), polyline->size() - 2);
+
+    const auto result = fast.GetTriangles();
+    BOOST_CHECK(p2t::IsDelaunay(result));
+    BOOST_CHECK(SortedTriangles(result) == SortedTriangles(swept.GetTriangles()));
+  }
+  for (const auto p : convex) {
+    delete p;
+  }
+  for (const auto p : monotone) {
+    delete p;
+  }
+
+  // One local minimum, but the chains cross: left to the sweep
+  std::vector<p2t::Point> crossing{ { 0, 0 }, { 2, 2 },  { -4, 4 }, { -2, 6 },
+                                    { 0, 8 }, { -6, 7 }, { -4, 5 }, { 2, 3 } };
+  std::vector<p2t::Point*> polyline;
+  for (auto& point : crossing) {
+    polyline.push_back(&point);
+  }
+  // The sweep keeps triangles with its artificial points here, so compare coordinates
+  const auto coordinates = [](const std::vector<p2t::Triangle*>& triangles) {
+    std::vector<std::array<std::pair<double, double>, 3>> result;
+    for (const auto t : triangles) {
+      std::array<std::pair<double, double>, 3> points;
+      for (int i = 0; i < 3; ++i) {
+        points[i] = { t->GetPoint(i)->x, t->GetPoint(i)->y };
+      }
+      std::sort(points.begin(), points.end());
+      result.push_back(points);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  p2t::CDT fast{ polyline };
+  fast.SetMonotoneFastPath(true);
+  fast.Triangulate();
+  BOOST_CHECK_GT(fast.GetMap().size(), polyline.size() - 2);
+  const auto result = coordinates(fast.GetTriangles());
+  for (auto& point : crossing) {
+    point.edge_list.clear();
+  }
+  p2t::CDT swept{ polyline };
+  swept.Triangulate();
+  BOOST_CHECK(result == coordinates(swept.GetTriangles()));
+}
+
+BOOST_AUTO_TEST_CASE(MonotoneFastPathDelaunayTest)
+{
+  // Larger random inputs where the sweep leaves some edges unlegalized
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> random(0, 1);
+  std::vector<p2t::Point*> monotone{ new p2t::Point(0, 0) };
+  for (int i = 1; i < 30; ++i) {
+    monotone.push_back(new p2t::Point(std::round(1000 + 1000 * random(generator)),
+                                      std::round(1000 * i + 500 * random(generator))));
+  }
+  monotone.push_back(new p2t::Point(0, 30000));
+  for (int i = 29; i > 0; --i) {
+    monotone.push_back(new p2t::Point(std::round(-1000 - 1000 * random(generator)),
+                                      std::round(1000 * i + 500 * random(generator))));
+  }
+  p2t::CDT cdt{ monotone };
+  cdt.SetMonotoneFastPath(true);
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+  const auto result = cdt.GetTriangles();
+  BOOST_REQUIRE_EQUAL(result.size(), monotone.size() - 2);
+  BOOST_CHECK(p2t::IsDelaunay(result));
+  for (const auto p : monotone) {
+    delete p;
+  }
+
+  // Convex polygons take a separate path
+  const double pi = 3.14159265358979323846;
+  std::vector<double> angles(200);
+  for (auto& angle : angles) {
+    angle = 2 * pi * random(generator);
+  }
+  std::sort(angles.begin(), angles.end());
+  std::vector<p2t::Point*> convex;
+  for (const double angle : angles) {
+    // Large enough that rounding to integers keeps it convex
+    convex.push_back(
+      new p2t::Point(std::round(3e7 * std::cos(angle)), std::round(1e7 * std::sin(angle))));
+  }
+  p2t::CDT convex_cdt{ convex };
+  convex_cdt.SetMonotoneFastPath(true);
+  BOOST_CHECK_NO_THROW(convex_cdt.Triangulate());
+  const auto convex_result = convex_cdt.GetTriangles();
+  BOOST_REQUIRE_EQUAL(convex_result.size(), convex.size() - 2);
+  BOOST_CHECK(p2t::IsDelaunay(convex_result));
+  for (const auto p : convex) {
+    delete p;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SmallPolygonTest)
+{
+  // A quad and a star shaped glyph, compared against the sweep
+  const std::vector<std::vector<p2t::Point>> shapes{
+    { { 0, 0 }, { 10, 0 }, { 12, 10 }, { 0, 10 } },
+    { { 0, -30 }, { 6, -8 }, { 25, -10 }, { 11, 2 }, { 20, 22 }, { 3, 12 },
+      { -16, 26 }, { -10, 4 }, { -28, -7 }, { -7, -9 } },
+  };
+  for (const auto& shape : shapes) {
+    std::vector<p2t::Point*> polyline;
+    for (const auto& point : shape) {
+      polyline.push_back(new p2t::Point(point.x, point.y));
+    }
+    p2t::SmallTriangulation small;
+    BOOST_REQUIRE(p2t::TriangulateSmallPolygon(polyline.data(), polyline.size(), small));
+    BOOST_REQUIRE_EQUAL(small.size, polyline.size() - 2);
+    std::vector<std::array<p2t::Point*, 3>> triangles;
+    size_t constrained = 0;
+    for (size_t i = 0; i < small.size; ++i) {
+      std::array<p2t::Point*, 3> points;
+      for (int j = 0; j < 3; ++j) {
+        points[j] = polyline[small.triangles[i][j]];
+        constrained += small.constrained_edge[i][j];
+      }
+      BOOST_CHECK_GT(p2t::Cross(*points[1] - *points[0], *points[2] - *points[0]), 0);
+      std::sort(points.begin(), points.end());
+      triangles.push_back(points);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    BOOST_CHECK_EQUAL(constrained, polyline.size());
+
+    p2t::CDT cdt{ polyline };
+    cdt.SetMonotoneFastPath(false);
+    cdt.Triangulate();
+    BOOST_CHECK(triangles == SortedTriangles(cdt.GetTriangles()));
+    for (const auto p : polyline) {
+      delete p;
+    }
+  }
+
+  std::vector<p2t::Point> points;
+  for (int i = 0; i < 17; ++i) {
+    points.emplace_back(std::round(1000 * std::cos(i * 0.3)), std::round(1000 * std::sin(i * 0.3)));
+  }
+  std::vector<const p2t::Point*> polyline;
+  for (const auto& point : points) {
+    polyline.push_back(&point);
+  }
+  p2t::SmallTriangulation small;
+  BOOST_CHECK(!p2t::TriangulateSmallPolygon(polyline.data(), polyline.size(), small));
+  BOOST_CHECK(p2t::TriangulateSmallPolygon(polyline.data(), 16, small));
+  polyline[3] = polyline[1];
+  BOOST_CHECK(!p2t::TriangulateSmallPolygon(polyline.data(), 4, small));
+
+  // A pentagram has ears, but they overlap
+  std::vector<p2t::Point> pentagram;
+  for (int i = 0; i < 5; ++i) {
+    pentagram.emplace_back(std::round(1000 * std::cos(i * 4 * M_PI / 5)),
+                           std::round(1000 * std::sin(i * 4 * M_PI / 5)));
+  }
+  polyline.clear();
+  for (const auto& point : pentagram) {
+    polyline.push_back(&point);
+  }
+  BOOST_CHECK(!p2t::TriangulateSmallPolygon(polyline.data(), polyline.size(), small));
+}
+
+BOOST_AUTO_TEST_CASE(InsertPointTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4000, 200),
+                                     new p2t::Point(4500, 3000), new p2t::Point(300, 4000) };
+  p2t::CDT cdt{ polyline };
+  BOOST_CHECK_THROW(cdt.InsertPoint(polyline[0]), std::runtime_error);
+  cdt.Triangulate();
+
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> random(0.1, 0.9);
+  std::vector<p2t::Point*> inserted;
+  for (int i = 0; i < 100; ++i) {
+    const double u = random(generator);
+    const double v = random(generator);
+    // Bilinear interpolation stays inside of the quad
+    const double x = (1 - v) * ((1 - u) * 0 + u * 4000) + v * ((1 - u) * 300 + u * 4500);
+    const double y = (1 - v) * ((1 - u) * 0 + u * 200) + v * ((1 - u) * 4000 + u * 3000);
+    inserted.push_back(new p2t::Point(std::round(x), std::round(y)));
+    BOOST_REQUIRE_NO_THROW(cdt.InsertPoint(inserted.back()));
+  }
+  // On the boundary, which stays constrained
+  inserted.push_back(new p2t::Point(2000, 100));
+  BOOST_REQUIRE_NO_THROW(cdt.InsertPoint(inserted.back()));
+
+  const auto result = cdt.GetTriangles();
+  BOOST_CHECK_EQUAL(result.size(), 2 + 2 * 100 + 1);
+  BOOST_CHECK(p2t::IsDelaunay(result));
+  size_t constrained = 0;
+  for (const auto t : result) {
+    constrained += t->constrained_edge[0] + t->constrained_edge[1] + t->constrained_edge[2];
+  }
+  BOOST_CHECK_EQUAL(constrained, 5);
+  // The edge list is split too, so that sweeping again keeps the point on the border
+  const p2t::Point* on_border = inserted.back();
+  BOOST_REQUIRE_EQUAL(on_border->edge_list.size(), 1);
+  BOOST_CHECK_EQUAL(on_border->edge_list[0]->p, polyline[0]);
+  const auto& upper = polyline[1]->edge_list;
+  BOOST_CHECK(std::any_of(upper.begin(), upper.end(),
+                          [&](const p2t::Edge* edge) { return edge->p == on_border; }));
+  BOOST_CHECK(std::none_of(upper.begin(), upper.end(),
+                           [&](const p2t::Edge* edge) { return edge->p == polyline[0]; }));
+
+  p2t::Point outside(5000, 5000);
+  BOOST_CHECK_THROW(cdt.InsertPoint(&outside), std::runtime_error);
+  p2t::Point repeat(*inserted.front());
+  BOOST_CHECK_THROW(cdt.InsertPoint(&repeat), std::runtime_error);
+  for (const auto p : polyline) {
+    delete p;
+  }
+  for (const auto p : inserted) {
+    delete p;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InsertConstraintTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4000, 0),
+                                     new p2t::Point(4000, 4000), new p2t::Point(0, 4000) };
+  p2t::CDT cdt{ polyline };
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> random(100, 3900);
+  std::vector<p2t::Point*> steiner;
+  for (int i = 0; i < 60; ++i) {
+    steiner.push_back(
+      new p2t::Point(std::round(random(generator)), std::round(random(generator))));
+    cdt.AddPoint(steiner.back());
+  }
+  cdt.Triangulate();
+
+  // Both endpoints are new, the segment passes through a vertex inserted on it before
+  p2t::Point p(500, 1000), q(3500, 2500), middle(2500, 2000);
+  cdt.InsertPoint(&middle);
+  cdt.InsertConstraint(&p, &q);
+  const auto result = cdt.GetTriangles();
+  BOOST_CHECK_EQUAL(result.size(), 2 + 2 * 63);
+  // The constrained edges on the segment add up to its length, twice as both sides count
+  double length = 0;
+  for (const auto t : result) {
+    for (int i = 0; i < 3; ++i) {
+      const p2t::Point& a = *t->GetPoint((i + 1) % 3);
+      const p2t::Point& b = *t->GetPoint((i + 2) % 3);
+      if (t->constrained_edge[i] && p2t::Cross(q - p, a - p) == 0 &&
+          p2t::Cross(q - p, b - p) == 0) {
+        length += (b - a).Length();
+      }
+    }
+  }
+  BOOST_CHECK_CLOSE(length, 2 * (q - p).Length(), kTolerance);
+
+  const auto snapshot = [&cdt] {
+    std::vector<std::tuple<p2t::Point*, p2t::Point*, p2t::Point*, bool, bool, bool>> corners;
+    for (const auto t : cdt.GetTriangles()) {
+      corners.emplace_back(t->GetPoint(0), t->GetPoint(1), t->GetPoint(2), t->constrained_edge[0],
+                           t->constrained_edge[1], t->constrained_edge[2]);
+    }
+    return corners;
+  };
+  const auto before = snapshot();
+  // Both endpoints are new and the segment crosses the one from p to q halfway
+  p2t::Point crossing_start(500, 2500), crossing_end(3500, 1000);
+  BOOST_CHECK_THROW(cdt.InsertConstraint(&crossing_start, &crossing_end), std::runtime_error);
+  p2t::Point outside(5000, 1000);
+  BOOST_CHECK_THROW(cdt.InsertConstraint(&p, &outside), std::runtime_error);
+  // The rejected segments left the triangulation as it was, no endpoint was inserted
+  BOOST_CHECK(snapshot() == before);
+  for (const auto point : polyline) {
+    delete point;
+  }
+  for (const auto point : steiner) {
+    delete point;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RemovePointTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4000, 0),
+                                     new p2t::Point(4000, 4000), new p2t::Point(0, 4000) };
+  p2t::CDT cdt{ polyline };
+  std::mt19937 generator(13);
+  std::uniform_real_distribution<double> random(100, 3900);
+  std::vector<p2t::Point*> steiner;
+  for (int i = 0; i < 60; ++i) {
+    steiner.push_back(
+      new p2t::Point(std::round(random(generator)), std::round(random(generator))));
+    cdt.AddPoint(steiner.back());
+  }
+  cdt.Triangulate();
+  p2t::Point p(500, 1000), q(3500, 2500), middle(2500, 2000);
+  cdt.InsertConstraint(&p, &q);
+  cdt.InsertPoint(&middle);
+
+  const auto area = [&cdt] {
+    double sum = 0;
+    for (const auto t : cdt.GetTriangles()) {
+      sum += p2t::Cross(*t->GetPoint(1) - *t->GetPoint(0), *t->GetPoint(2) - *t->GetPoint(0));
+    }
+    return sum / 2;
+  };
+  const auto constrained_length = [&cdt] {
+    double length = 0;
+    for (const auto t : cdt.GetTriangles()) {
+      for (int i = 0; i < 3; ++i) {
+        if (t->constrained_edge[i] && t->GetNeighbor(i) && t->GetNeighbor(i)->IsInterior()) {
+          length += (*t->GetPoint((i + 2) % 3) - *t->GetPoint((i + 1) % 3)).Length();
+        }
+      }
+    }
+    return length;
+  };
+  BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), 2 + 2 * 63);
+  BOOST_CHECK_CLOSE(constrained_length(), 2 * (q - p).Length(), kTolerance);
+
+  // The vertex splitting the constraint goes, the constraint stays
+  cdt.RemovePoint(&middle);
+  for (int i = 0; i < 30; ++i) {
+    cdt.RemovePoint(steiner[i]);
+  }
+  BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), 2 + 2 * 32);
+  BOOST_CHECK_CLOSE(area(), 16e6, kTolerance);
+  BOOST_CHECK_CLOSE(constrained_length(), 2 * (q - p).Length(), kTolerance);
+
+  BOOST_CHECK_THROW(cdt.RemovePoint(polyline[0]), std::runtime_error);
+  BOOST_CHECK_THROW(cdt.RemovePoint(&p), std::runtime_error);
+  BOOST_CHECK_THROW(cdt.RemoveConstraint(polyline[0], polyline[2]), std::runtime_error);
+  BOOST_CHECK_THROW(cdt.RemoveConstraint(polyline[0], polyline[1]), std::runtime_error);
+
+  cdt.RemoveConstraint(&q, &p);
+  BOOST_CHECK_EQUAL(constrained_length(), 0);
+  cdt.RemovePoint(&p);
+  const size_t map_size = cdt.GetMap().size();
+  cdt.RemovePoint(&q);
+  // The two triangles less are gone from the map right away
+  BOOST_CHECK_EQUAL(cdt.GetMap().size(), map_size - 2);
+  BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), 2 + 2 * 30);
+  for (const auto t : cdt.GetTriangles()) {
+    BOOST_CHECK(t->IsInterior());
+  }
+  BOOST_CHECK_CLOSE(area(), 16e6, kTolerance);
+  // The removed points and edges are only dropped from their lists now
+  cdt.Compact();
+  BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), 2 + 2 * 30);
+  BOOST_CHECK_CLOSE(area(), 16e6, kTolerance);
+  for (const auto point : polyline) {
+    delete point;
+  }
+  for (const auto point : steiner) {
+    delete point;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RetriangulateTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4000, 0),
+                                     new p2t::Point(4000, 4000), new p2t::Point(0, 4000) };
+  p2t::CDT cdt{ polyline };
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<double> random(300, 3700);
+  std::vector<p2t::Point*> steiner;
+  for (int i = 0; i < 40; ++i) {
+    steiner.push_back(
+      new p2t::Point(std::round(random(generator)), std::round(random(generator))));
+    cdt.AddPoint(steiner.back());
+  }
+  cdt.Triangulate();
+  const auto valid = [&cdt] {
+    const auto triangles = cdt.GetTriangles();
+    double area = 0;
+    for (const auto t : triangles) {
+      const double cross =
+        p2t::Cross(*t->GetPoint(1) - *t->GetPoint(0), *t->GetPoint(2) - *t->GetPoint(0));
+      if (cross <= 0) {
+        return false;
+      }
+      area += cross / 2;
+    }
+    return triangles.size() == 2 + 2 * 40 && std::abs(area - 16e6) < 16e6 * kTolerance / 100;
+  };
+
+  // A small smooth motion keeps the triangles
+  const auto before = cdt.GetTriangles();
+  for (const auto point : steiner) {
+    point->set(std::round(point->x + 100 * std::sin(point->y / 1000)),
+               std::round(point->y + 100 * std::cos(point->x / 1000)));
+  }
+  BOOST_CHECK(cdt.Retriangulate());
+  BOOST_CHECK(valid());
+  BOOST_CHECK(p2t::IsDelaunay(cdt.GetTriangles()));
+  BOOST_CHECK(cdt.GetTriangles() == before);
+
+  // Points that jumped past others are taken out and inserted again
+  steiner[0]->set(3900, 3850);
+  steiner[1]->set(150, 100);
+  BOOST_CHECK(cdt.Retriangulate());
+  BOOST_CHECK(valid());
+  BOOST_CHECK(p2t::IsDelaunay(cdt.GetTriangles()));
+
+  // Mirrored, every triangle is inverted and the points are swept again
+  for (const auto point : polyline) {
+    point->x = 4000 - point->x;
+  }
+  for (const auto point : steiner) {
+    point->x = 4000 - point->x;
+  }
+  BOOST_CHECK(!cdt.Retriangulate());
+  BOOST_CHECK(valid());
+
+  cdt.Compact();
+  BOOST_CHECK_THROW(cdt.Retriangulate(), std::runtime_error);
+  for (const auto point : polyline) {
+    delete point;
+  }
+  for (const auto point : steiner) {
+    delete point;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TriangulationCacheTest)
+{
+  // A square with a triangular hole, a translated and scaled copy and a different shape
+  const auto shape = [](double x, double y, double scale) {
+    std::vector<p2t::Point*> polyline{ new p2t::Point(x, y), new p2t::Point(x + 4 * scale, y),
+                                       new p2t::Point(x + 4 * scale, y + 4 * scale),
+                                       new p2t::Point(x, y + 4 * scale) };
+    std::vector<p2t::Point*> hole{ new p2t::Point(x + scale, y + scale),
+                                   new p2t::Point(x + 3 * scale, y + scale),
+                                   new p2t::Point(x + 2 * scale, y + 3 * scale) };
+    return std::make_pair(polyline, hole);
+  };
+  auto original = shape(0, 0, 4);
+  auto copy = shape(-70, 4001, 1);
+  std::vector<p2t::Point*> other{ new p2t::Point(0, 0), new p2t::Point(8, 0),
+                                  new p2t::Point(4, 4) };
+
+  p2t::TriangulationCache cache(1);
+  const std::vector<size_t> first = cache.Triangulate(original.first, { original.second });
+  BOOST_CHECK_EQUAL(first.size(), 3 * 7);
+  BOOST_CHECK(original.first[0]->edge_list.empty());
+  const std::vector<size_t> second = cache.Triangulate(copy.first, { copy.second });
+  BOOST_CHECK(first == second);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().hits, 1);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 1);
+
+  // The hole makes a difference
+  BOOST_CHECK_EQUAL(cache.Triangulate(original.first).size(), 3 * 2);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 2);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().evictions, 1);
+  BOOST_CHECK_EQUAL(cache.Triangulate(other).size(), 3);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().evictions, 2);
+  cache.Triangulate(copy.first, { copy.second });
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 4);
+
+  for (const auto& points : { original.first, original.second, copy.first, copy.second, other }) {
+    for (const auto point : points) {
+      delete point;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DiskCacheTest)
+{
+  namespace fs = boost::filesystem;
+  const fs::path directory = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(directory);
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(8, 0),
+                                     new p2t::Point(8, 8), new p2t::Point(0, 8) };
+  std::vector<p2t::Point*> hole{ new p2t::Point(2, 2), new p2t::Point(6, 2),
+                                 new p2t::Point(4, 6) };
+  p2t::Point steiner(7, 7);
+
+  std::string path;
+  std::vector<uint32_t> triangles, neighbors;
+  {
+    p2t::DiskCache cache(directory.string());
+    const p2t::MappedMesh mesh = cache.Triangulate(polyline, { hole }, { &steiner });
+    const p2t::MeshView& view = mesh.view();
+    path = mesh.path();
+    BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 1);
+    BOOST_REQUIRE_EQUAL(view.vertex_count(), 8);
+    BOOST_CHECK_EQUAL(view.vertices()[14], 7);
+    BOOST_REQUIRE_EQUAL(view.triangle_count(), 9);
+    BOOST_CHECK(polyline[0]->edge_list.empty());
+    size_t constrained = 0;
+    for (size_t t = 0; t < view.triangle_count(); t++) {
+      for (int i = 0; i < 3; i++) {
+        const uint32_t neighbor = view.neighbors()[3 * t + i];
+        const bool border = (view.constrained()[t] >> i) & 1;
+        constrained += border;
+        // Only the polygon and the hole are constrained, and they are the border
+        BOOST_CHECK_EQUAL(border, neighbor == p2t::kNoNeighbor);
+        if (neighbor != p2t::kNoNeighbor) {
+          const uint32_t* back = view.neighbors() + 3 * neighbor;
+          BOOST_CHECK(std::count(back, back + 3, t) == 1);
+        }
+      }
+    }
+    BOOST_CHECK_EQUAL(constrained, 7);
+    triangles.assign(view.triangles(), view.triangles() + 3 * view.triangle_count());
+    neighbors.assign(view.neighbors(), view.neighbors() + 3 * view.triangle_count());
+  }
+
+  // Another process started later maps the file
+  p2t::DiskCache cache(directory.string());
+  const p2t::MappedMesh mesh = cache.Triangulate(polyline, { hole }, { &steiner });
+  BOOST_CHECK_EQUAL(cache.GetStatistics().hits, 1);
+  BOOST_CHECK_EQUAL(mesh.path(), path);
+  BOOST_CHECK(std::equal(triangles.begin(), triangles.end(), mesh.view().triangles()));
+  BOOST_CHECK(std::equal(neighbors.begin(), neighbors.end(), mesh.view().neighbors()));
+
+  // Moving a point gives another file, a broken file is written again
+  steiner.x = 6;
+  BOOST_CHECK(cache.Triangulate(polyline, { hole }, { &steiner }).path() != path);
+  steiner.x = 7;
+  fs::resize_file(path, 100);
+  BOOST_CHECK_THROW(p2t::MappedMesh{ path }, std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.Triangulate(polyline, { hole }, { &steiner }).view().triangle_count(),
+                    9);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 2);
+  {
+    // Same size, but the first corner points past the vertices
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(sizeof(p2t::MeshFileHeader) + 8 * 2 * sizeof(double));
+    const uint32_t corner = 8;
+    file.write(reinterpret_cast<const char*>(&corner), sizeof(corner));
+  }
+  BOOST_CHECK_THROW(p2t::MappedMesh{ path }, std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.Triangulate(polyline, { hole }, { &steiner }).view().triangle_count(),
+                    9);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 3);
+
+  fs::remove_all(directory);
+  for (const auto& points : { polyline, hole }) {
+    for (const auto point : points) {
+      delete point;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TriangulationCacheDelaunayTest)
+{
+  // Two quads whose normalized coordinates round to the same key. The last point lies just
+  // inside the circle through the others in the first one and just outside in the second, so
+  // their Delaunay triangulations use different diagonals.
+#ifdef P2T_INTEGER_COORDINATES
+  const double size = (1 << 28) - 1, inside = 1, outside = 0, top = size + 1;
+#else
+  const double size = 1, inside = 1e-10, outside = -1e-10, top = size;
+#endif
+  std::vector<p2t::Point> first{ { 0, 0 }, { size, 0 }, { size, size }, { inside, size } };
+  std::vector<p2t::Point> second{ { 0, 0 }, { size, 0 }, { size, size }, { outside, top } };
+  const auto pointers = [](std::vector<p2t::Point>& points) {
+    std::vector<p2t::Point*> polyline;
+    for (auto& point : points) {
+      polyline.push_back(&point);
+    }
+    return polyline;
+  };
+  const auto diagonal = [](const std::vector<size_t>& triangles) {
+    // The corner both triangles share apart from the diagonal's other end
+    std::vector<size_t> count(4);
+    for (const size_t index : triangles) {
+      count[index]++;
+    }
+    return count[0] == 2 ? 0 : 1;
+  };
+
+  p2t::TriangulationCache cache(1);
+  const std::vector<size_t> from_first = cache.Triangulate(pointers(first));
+  BOOST_CHECK_EQUAL(diagonal(from_first), 1);
+  const std::vector<size_t> from_second = cache.Triangulate(pointers(second));
+  BOOST_CHECK_EQUAL(diagonal(from_second), 0);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().hits, 1);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().repairs, 1);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 1);
+  BOOST_CHECK_EQUAL(diagonal(cache.Triangulate(pointers(first))), 1);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().hits, 2);
+  BOOST_CHECK_EQUAL(cache.GetStatistics().repairs, 1);
+
+  // A star in general position has one Delaunay triangulation wherever it is placed
+  std::mt19937 generator(35);
+  std::uniform_real_distribution<double> random(0, 1);
+  std::vector<std::pair<double, double>> star;
+  for (int i = 0; i < 24; i++) {
+    const double angle = 2 * M_PI * (i + random(generator) / 2) / 24;
+    const double radius = (i % 2 ? 400 : 1000) + 100 * random(generator);
+    star.emplace_back(std::round(radius * std::cos(angle)), std::round(radius * std::sin(angle)));
+  }
+  const auto normalized = [](std::vector<size_t> triangles) {
+    std::vector<std::array<size_t, 3>> sorted;
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+      std::rotate(triangles.begin() + i,
+                  std::min_element(triangles.begin() + i, triangles.begin() + i + 3),
+                  triangles.begin() + i + 3);
+      sorted.push_back({ { triangles[i], triangles[i + 1], triangles[i + 2] } });
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+  };
+#ifdef P2T_INTEGER_COORDINATES
+  const bool integer = true;
+#else
+  // Copies placed in float round to different keys
+  const bool integer = std::numeric_limits<p2t::Scalar>::digits < 53;
+#endif
+  const auto place = [&](const std::vector<std::pair<double, double>>& shape) {
+    double x = 10000 * random(generator), y = 10000 * random(generator);
+    double scale = 1 + 4 * random(generator);
+    if (integer) {
+      x = std::round(x);
+      y = std::round(y);
+      scale = std::round(scale);
+    }
+    std::vector<p2t::Point> placed;
+    for (const auto& point : shape) {
+      placed.emplace_back(x + scale * point.first, y + scale * point.second);
+    }
+    return placed;
+  };
+  p2t::TriangulationCache uncached(0);
+  for (int i = 0; i < 100; i++) {
+    std::vector<p2t::Point> placed = place(star);
+    const std::vector<size_t> expected = uncached.Triangulate(pointers(placed));
+    BOOST_CHECK(normalized(cache.Triangulate(pointers(placed))) == normalized(expected));
+  }
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 2);
+
+  // A star with two rings of ten cocircular points. Either diagonal of four of them is Delaunay,
+  // but no point may lie inside the circumcircle across an edge.
+  std::vector<std::pair<double, double>> circle;
+  for (const auto& offset : { std::make_pair(0, 25), std::make_pair(7, 24),
+                              std::make_pair(15, 20), std::make_pair(20, 15),
+                              std::make_pair(24, 7) }) {
+    circle.emplace_back(offset.first, offset.second);
+    circle.emplace_back(offset.second, -offset.first);
+    circle.emplace_back(-offset.first, -offset.second);
+    circle.emplace_back(-offset.second, offset.first);
+  }
+  std::sort(circle.begin(), circle.end(), [](const std::pair<double, double>& a,
+                                             const std::pair<double, double>& b) {
+    return std::atan2(a.second, a.first) < std::atan2(b.second, b.first);
+  });
+  for (size_t i = 1; i < circle.size(); i += 2) {
+    circle[i].first *= 2;
+    circle[i].second *= 2;
+  }
+  for (int i = 0; i < 100; i++) {
+    // Integer coordinates to compute the determinant exactly
+    std::vector<p2t::Point> placed;
+    const int64_t x = i * 37 % 1000, y = i * 91 % 1000, scale = 1 + i % 3;
+    for (const auto& point : circle) {
+      placed.emplace_back(x + scale * point.first, y + scale * point.second);
+    }
+    const std::vector<size_t>& triangles = cache.Triangulate(pointers(placed));
+    BOOST_REQUIRE_EQUAL(triangles.size(), 3 * 18);
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+      for (size_t u = 0; u < triangles.size(); u += 3) {
+        for (size_t i = 0; i < 3; i++) {
+          for (size_t j = 0; j < 3; j++) {
+            if (triangles[t + (i + 1) % 3] != triangles[u + (j + 2) % 3] ||
+                triangles[t + (i + 2) % 3] != triangles[u + (j + 1) % 3]) {
+              continue;
+            }
+            int64_t d[3][2];
+            for (size_t k = 0; k < 3; k++) {
+              const p2t::Point& corner = placed[triangles[t + (i + k) % 3]];
+              const p2t::Point& opposite = placed[triangles[u + j]];
+              d[k][0] = static_cast<int64_t>(corner.x - opposite.x);
+              d[k][1] = static_cast<int64_t>(corner.y - opposite.y);
+            }
+            int64_t det = 0;
+            for (size_t k = 0; k < 3; k++) {
+              const int64_t* b = d[(k + 1) % 3];
+              const int64_t* c = d[(k + 2) % 3];
+              det += (d[k][0] * d[k][0] + d[k][1] * d[k][1]) * (b[0] * c[1] - c[0] * b[1]);
+            }
+            BOOST_CHECK_LE(det, 0);
+          }
+        }
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(cache.GetStatistics().misses, 3);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFormatTest)
+{
+  std::vector<p2t::Point*> polyline{ new p2t::Point(0, 0), new p2t::Point(4, 0),
+                                     new p2t::Point(4, 4), new p2t::Point(0, 4) };
+  std::vector<p2t::Point*> hole{ new p2t::Point(1, 1), new p2t::Point(3, 1),
+                                 new p2t::Point(2, 3) };
+  p2t::CDT cdt{ polyline };
+  cdt.AddHole(hole);
+  cdt.Triangulate();
+  std::stringstream stream;
+  p2t::WriteMesh(stream, cdt, 42);
+  const std::string bytes = stream.str();
+  std::vector<uint64_t> buffer((bytes.size() + 7) / 8);
+  std::memcpy(buffer.data(), bytes.data(), bytes.size());
+
+  const p2t::MeshView view(buffer.data(), bytes.size());
+  const std::vector<p2t::Triangle*> triangles = cdt.GetTriangles();
+  BOOST_CHECK_EQUAL(view.input_hash(), 42);
+  BOOST_REQUIRE_EQUAL(view.triangle_count(), triangles.size());
+  BOOST_REQUIRE_EQUAL(view.vertex_count(), 7);
+  const auto index_of = [&](const p2t::Triangle* t) {
+    const auto it = std::find(triangles.begin(), triangles.end(), t);
+    return it == triangles.end() ? p2t::kNoNeighbor : uint32_t(it - triangles.begin());
+  };
+  for (uint32_t t = 0; t < view.triangle_count(); t++) {
+    for (int i = 0; i < 3; i++) {
+      const uint32_t v = view.GetPoint(t, i);
+      const p2t::Point& point = *triangles[t]->GetPoint(i);
+      BOOST_CHECK_EQUAL(view.GetVertex(v)[0], point.x);
+      BOOST_CHECK_EQUAL(view.GetVertex(v)[1], point.y);
+      BOOST_CHECK_EQUAL(view.Index(t, v), i);
+      BOOST_CHECK_EQUAL(view.GetNeighbor(t, i), index_of(triangles[t]->GetNeighbor(i)));
+      BOOST_CHECK_EQUAL(view.IsConstrained(t, i), triangles[t]->constrained_edge[i]);
+      BOOST_CHECK_EQUAL(view.NeighborCW(t, v), index_of(triangles[t]->NeighborCW(point)));
+      BOOST_CHECK_EQUAL(view.NeighborCCW(t, v), index_of(triangles[t]->NeighborCCW(point)));
+      BOOST_CHECK_EQUAL(view.NeighborAcross(t, v), index_of(triangles[t]->NeighborAcross(point)));
+      BOOST_CHECK_EQUAL(view.PointCW(t, v), view.GetPoint(t, (i + 2) % 3));
+      BOOST_CHECK_EQUAL(view.PointCCW(t, v), view.GetPoint(t, (i + 1) % 3));
+      BOOST_CHECK_EQUAL(view.EdgeIndex(t, view.PointCW(t, v), view.PointCCW(t, v)), i);
+    }
+    BOOST_CHECK_EQUAL(view.Index(t, view.vertex_count()), -1);
+    BOOST_CHECK_THROW(view.PointCW(t, view.vertex_count()), std::runtime_error);
+    BOOST_CHECK_THROW(view.NeighborAcross(t, view.vertex_count()), std::runtime_error);
+  }
+  // Vertices keep the input order
+  const std::vector<p2t::Point*> input = cdt.GetInputPoints();
+  BOOST_REQUIRE_EQUAL(input.size(), 7);
+  for (uint32_t v = 0; v < view.vertex_count(); v++) {
+    BOOST_CHECK(input[v] == (v < 4 ? polyline[v] : hole[v - 4]));
+    BOOST_CHECK_EQUAL(view.GetVertex(v)[0], input[v]->x);
+    BOOST_CHECK_EQUAL(view.GetVertex(v)[1], input[v]->y);
+  }
+
+  // Files from a machine with the other byte order and broken files are rejected
+  std::vector<uint64_t> broken = buffer;
+  char* version = reinterpret_cast<char*>(broken.data()) + 4;
+  std::reverse(version, version + 4);
+  BOOST_CHECK_THROW(p2t::MeshView(broken.data(), bytes.size()), std::runtime_error);
+  BOOST_CHECK_THROW(p2t::MeshView(buffer.data(), bytes.size() - 1), std::runtime_error);
+  // So are indices out of range, the navigation doesn't check them
+  const size_t corners = (sizeof(p2t::MeshFileHeader) + 2 * sizeof(double) * 7) / sizeof(uint32_t);
+  broken = buffer;
+  reinterpret_cast<uint32_t*>(broken.data())[corners] = 7;
+  BOOST_CHECK_THROW(p2t::MeshView(broken.data(), bytes.size()), std::runtime_error);
+  broken = buffer;
+  reinterpret_cast<uint32_t*>(broken.data())[corners + 3 * triangles.size()] =
+      static_cast<uint32_t>(triangles.size());
+  BOOST_CHECK_THROW(p2t::MeshView(broken.data(), bytes.size()), std::runtime_error);
+  for (const auto p : polyline) {
+    delete p;
+  }
+  for (const auto p : hole) {
+    delete p;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DatFileTest)
+{
+#ifndef P2T_BASE_DIR
+  const auto basedir = boost::filesystem::path(__FILE__).remove_filename().parent_path();
+#else
+  const auto basedir = boost::filesystem::path(P2T_BASE_DIR);
+#endif
+  for (const auto& entry :
+       boost::filesystem::directory_iterator(basedir / boost::filesystem::path("testbed/data"))) {
+    if (entry.path().extension() != ".dat") {
+      continue;
+    }
+    const p2t::DatFile file(entry.path().string());
+    // Same numbers as with the standard library
+    std::ifstream stream(entry.path().string());
+    std::vector<std::pair<double, double>> expected;
+    std::string x, y;
+    while (stream >> x) {
+      if (x != "HOLE" && x != "STEINER") {
+        stream >> y;
+        expected.emplace_back(std::stod(x), std::stod(y));
+      }
+    }
+    BOOST_REQUIRE_EQUAL(file.points().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      BOOST_CHECK_EQUAL(file.points()[i].x, static_cast<p2t::Scalar>(expected[i].first));
+      BOOST_CHECK_EQUAL(file.points()[i].y, static_cast<p2t::Scalar>(expected[i].second));
+    }
+    if (entry.path().filename() == "dude.dat") {
+      BOOST_CHECK_EQUAL(file.holes().size(), 2);
+      BOOST_CHECK_EQUAL(file.polyline().size() + file.holes()[0].size() + file.holes()[1].size(),
+                        expected.size());
+    }
+  }
+
+  const std::string text = "0 0\n8 0\r\n  0.9e1\t8 extra\n0 8\nHOLE\n2 2\n6 2\n4 6\nSTEINER\n"
+                           "7 7\n\nignored after the blank line";
+  p2t::DatFile file = p2t::DatFile::Parse(text.data(), text.size());
+  BOOST_REQUIRE_EQUAL(file.polyline().size(), 4);
+  BOOST_CHECK_EQUAL(file.polyline()[2]->x, 9);
+  BOOST_REQUIRE_EQUAL(file.holes().size(), 1);
+  BOOST_CHECK_EQUAL(file.holes()[0].size(), 3);
+  BOOST_REQUIRE_EQUAL(file.steiner().size(), 1);
+  BOOST_CHECK_EQUAL(file.steiner()[0], &file.points()[7]);
+  p2t::CDT cdt(file.polyline());
+  cdt.AddHole(file.holes()[0]);
+  cdt.AddPoint(file.steiner()[0]);
+  cdt.Triangulate();
+  BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), 9);
+
+  for (const std::string invalid : { "0 0\n1 x\n", "0 0\nHOLES\n", "0\n", "0,0 1\n" }) {
+    BOOST_CHECK_THROW(p2t::DatFile::Parse(invalid.data(), invalid.size()), std::runtime_error);
+  }
+  BOOST_CHECK_THROW(p2t::DatFile("does/not/exist.dat"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(PolygonReaderTest)
+{
+  // Triangulates every polygon as soon as it has been read
+  struct Triangulator : p2t::PolygonVisitor {
+    std::vector<size_t> triangles;
+    std::vector<double> first_outline;
+    void Visit(const std::vector<p2t::Point*>& outline,
+               const std::vector<std::vector<p2t::Point*>>& holes) override
+    {
+      if (first_outline.empty()) {
+        for (const p2t::Point* point : outline) {
+          first_outline.push_back(point->x);
+          first_outline.push_back(point->y);
+        }
+      }
+      p2t::CDT cdt(outline);
+      for (const auto& hole : holes) {
+        cdt.AddHole(hole);
+      }
+      cdt.Triangulate();
+      triangles.push_back(cdt.GetTriangles().size());
+    }
+  };
+
+  std::string wkb;
+  const auto add = [&wkb](const void* data, size_t size, bool big_endian) {
+    std::string bytes(static_cast<const char*>(data), size);
+    if (big_endian) {
+      std::reverse(bytes.begin(), bytes.end());
+    }
+    wkb += bytes;
+  };
+  const auto add_header = [&](bool big_endian, uint32_t type) {
+    wkb += big_endian ? '\0' : '\1';
+    add(&type, 4, big_endian);
+  };
+  const auto add_rings = [&](bool big_endian, std::vector<std::vector<double>> rings,
+                             int dimensions) {
+    uint32_t count = static_cast<uint32_t>(rings.size());
+    add(&count, 4, big_endian);
+    for (const auto& ring : rings) {
+      count = static_cast<uint32_t>(ring.size() / 2);
+      add(&count, 4, big_endian);
+      for (size_t i = 0; i < ring.size(); i += 2) {
+        for (int d = 0; d < dimensions; d++) {
+          const double coordinate = d < 2 ? ring[i + d] : 5;
+          add(&coordinate, 8, big_endian);
+        }
+      }
+    }
+  };
+  const std::vector<double> square{ 0, 0, 4, 0, 4, 4, 0, 4, 0, 0 };
+  const std::vector<double> hole{ 1, 1, 3, 1, 2, 3, 1, 1 };
+  const std::vector<double> triangle{ 10, 0, 12, 0, 11, 2, 10, 0 };
+  const std::vector<double> degenerate{ 0, 0, 1, 1, 0, 0 };
+  // A MultiPolygon, a big endian Polygon Z, an EWKB Polygon with SRID and only two points
+  add_header(false, 6);
+  const uint32_t two = 2;
+  add(&two, 4, false);
+  add_header(false, 3);
+  add_rings(false, { square, hole }, 2);
+  add_header(false, 3);
+  add_rings(false, { triangle }, 2);
+  add_header(true, 1003);
+  add_rings(true, { triangle }, 3);
+  add_header(false, 0x20000003);
+  const uint32_t srid = 4326;
+  add(&srid, 4, false);
+  add_rings(false, { degenerate }, 2);
+
+  Triangulator from_wkb;
+  std::istringstream wkb_stream(wkb);
+  p2t::ReadWkb(wkb_stream, from_wkb);
+  BOOST_CHECK((from_wkb.triangles == std::vector<size_t>{ 7, 1, 1 }));
+  BOOST_CHECK((from_wkb.first_outline == std::vector<double>{ 0, 0, 4, 0, 4, 4, 0, 4 }));
+
+  std::istringstream wkt_stream(
+    "MULTIPOLYGON (((0 0, 4 0, 4 4, 0 4, 0 0), (1 1, 3 1, 2 3, 1 1)), ((10 0,12 0,11 2,10 0)))\n"
+    "POLYGON Z ((10 0 5, 12 0 5, 11 2 5, 10 0 5))\n"
+    "SRID=4326;polygonm((0 0 1, 1 1 1, 0 0 1))\n"
+    "GEOMETRYCOLLECTION (POLYGON EMPTY, MULTIPOLYGON EMPTY)\n");
+  Triangulator from_wkt;
+  p2t::ReadWkt(wkt_stream, from_wkt);
+  BOOST_CHECK(from_wkt.triangles == from_wkb.triangles);
+  BOOST_CHECK(from_wkt.first_outline == from_wkb.first_outline);
+
+  Triangulator ignored;
+  std::istringstream truncated(wkb.substr(0, 50));
+  BOOST_CHECK_THROW(p2t::ReadWkb(truncated, ignored), std::runtime_error);
+  for (const char* invalid : { "POLYGON ((0 0, 1 x, 0 1))", "LINESTRING (0 0, 1 1)",
+                               "POLYGON ((0 0, 1 0, 0 1)" }) {
+    std::istringstream stream(invalid);
+    BOOST_CHECK_THROW(p2t::ReadWkt(stream, ignored), std::runtime_error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PointCloudTest)
+{
+  const auto area = [](const std::vector<p2t::Triangle*>& triangles) {
+    double sum = 0;
+    for (p2t::Triangle* t : triangles) {
+      const p2t::Point& a = *t->GetPoint(0);
+      const p2t::Point& b = *t->GetPoint(1);
+      const p2t::Point& c = *t->GetPoint(2);
+      const double doubled = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+      BOOST_CHECK_GT(doubled, 0);
+      sum += doubled / 2;
+    }
+    return sum;
+  };
+
+  // Random points in a square, the corners are the convex hull
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> random(1e4, 99e4);
+  std::vector<p2t::Point> points{ { 0, 0 }, { 1e6, 0 }, { 1e6, 1e6 }, { 0, 1e6 } };
+  for (int i = 0; i < 500; i++) {
+    points.emplace_back(std::round(random(generator)), std::round(random(generator)));
+  }
+  {
+    p2t::CDT cdt;
+    for (p2t::Point& point : points) {
+      cdt.AddPoint(&point);
+    }
+    BOOST_CHECK_THROW(cdt.AddHole({ &points[0], &points[1], &points[2] }), std::runtime_error);
+    cdt.Triangulate();
+    const auto triangles = cdt.GetTriangles();
+    BOOST_CHECK_EQUAL(triangles.size(), 2 * points.size() - 4 - 2);
+    BOOST_CHECK_CLOSE(area(triangles), 1e12, kTolerance);
+    BOOST_CHECK(p2t::IsDelaunay(triangles));
+    for (p2t::Triangle* t : triangles) {
+      for (int i = 0; i < 3; i++) {
+        // Only the edges on the hull are constrained
+        BOOST_CHECK_EQUAL(t->constrained_edge[i], t->GetNeighbor(i) == nullptr ||
+                                                    !t->GetNeighbor(i)->IsInterior());
+      }
+    }
+  }
+
+  // A grid has 28 points on the hull, many of them collinear
+  std::vector<p2t::Point> grid;
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < 8; x++) {
+      grid.emplace_back(x, y);
+    }
+  }
+  struct Counter : p2t::TriangleVisitor {
+    size_t count = 0;
+    void Visit(const size_t[3], const bool[3]) override
+    {
+      count++;
+    }
+  } counter;
+  {
+    p2t::CDT cdt;
+    for (p2t::Point& point : grid) {
+      cdt.AddPoint(&point);
+    }
+    cdt.Triangulate(counter);
+  }
+  BOOST_CHECK_EQUAL(counter.count, 2 * grid.size() - 28 - 2);
+  {
+    p2t::CDT cdt;
+    for (p2t::Point& point : grid) {
+      cdt.AddPoint(&point);
+    }
+    cdt.Triangulate();
+    BOOST_CHECK_EQUAL(cdt.GetTriangles().size(), counter.count);
+    BOOST_CHECK_CLOSE(area(cdt.GetTriangles()), 49, kTolerance);
+  }
+
+  // Points on a line don't span any triangle
+  std::vector<p2t::Point> line{ { 0, 0 }, { 4, 2 }, { 8, 4 }, { 2, 1 } };
+  p2t::CDT cdt;
+  for (p2t::Point& point : line) {
+    cdt.AddPoint(&point);
+  }
+  BOOST_CHECK_NO_THROW(cdt.Triangulate());
+  BOOST_CHECK(cdt.GetTriangles().empty());
+}
+
+BOOST_AUTO_TEST_CASE(PointCloudDelaunayTest)
+{
+  // Exact for the small integer coordinates below, positive if d is inside the circumcircle of
+  // the counter-clockwise a, b, c
+  const auto incircle = [](const p2t::Point& a, const p2t::Point& b, const p2t::Point& c,
+                           const p2t::Point& d) {
+    const int64_t adx = static_cast<int64_t>(a.x - d.x), ady = static_cast<int64_t>(a.y - d.y);
+    const int64_t bdx = static_cast<int64_t>(b.x - d.x), bdy = static_cast<int64_t>(b.y - d.y);
+    const int64_t cdx = static_cast<int64_t>(c.x - d.x), cdy = static_cast<int64_t>(c.y - d.y);
+    return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+           (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+           (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+  };
+
+  // No point may lie inside the circumcircle of any triangle. The small squares have many
+  // collinear and cocircular points.
+  for (unsigned seed = 0; seed < 100; seed++) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> random(0, seed % 2 == 0 ? 1000 : 30);
+    std::set<std::pair<int, int>> unique;
+    while (unique.size() < 200) {
+      unique.emplace(random(generator), random(generator));
+    }
+    std::vector<p2t::Point> points;
+    for (const auto& point : unique) {
+      points.emplace_back(point.first, point.second);
+    }
+    p2t::CDT cdt;
+    for (p2t::Point& point : points) {
+      cdt.AddPoint(&point);
+    }
+    cdt.Triangulate();
+    const std::vector<p2t::Triangle*> triangles = cdt.GetTriangles();
+    BOOST_REQUIRE(!triangles.empty());
+    size_t violations = 0;
+    for (p2t::Triangle* t : triangles) {
+      const p2t::Point& a = *t->GetPoint(0);
+      const p2t::Point& b = *t->GetPoint(1);
+      const p2t::Point& c = *t->GetPoint(2);
+      BOOST_CHECK_EQUAL(p2t::Orient2d(a, b, c), p2t::CCW);
+      for (const p2t::Point& point : points) {
+        if (incircle(a, b, c, point) > 0) {
+          violations++;
+        }
+      }
+    }
+    BOOST_CHECK_MESSAGE(violations == 0, "seed " << seed << ": " << violations << " violations");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RingTest)
+{
+  // Six parcels sharing their borders, a triangle inside the first one and a lone point
+  std::vector<p2t::Point> grid;
+  for (int y = 0; y < 3; y++) {
+    for (int x = 0; x < 4; x++) {
+      grid.emplace_back(10 * x, 10 * y);
+    }
+  }
+  std::vector<std::vector<p2t::Point*>> parcels;
+  for (int y = 0; y < 2; y++) {
+    for (int x = 0; x < 3; x++) {
+      parcels.push_back({ &grid[y * 4 + x], &grid[y * 4 + x + 1], &grid[y * 4 + x + 5],
+                          &grid[y * 4 + x + 4] });
+    }
+  }
+  std::vector<p2t::Point> inner{ { 2, 2 }, { 8, 2 }, { 5, 8 } };
+  p2t::Point lone(50, 50);
+
+  struct Result {
+    std::vector<double> areas;
+    size_t constrained = 0;
+  };
+  const auto triangulate = [&](p2t::FillRule rule, bool inner_ccw) {
+    // The edges of the previous run are gone
+    for (auto* points : { &grid, &inner }) {
+      for (p2t::Point& point : *points) {
+        point.edge_list.clear();
+      }
+    }
+    p2t::CDT cdt;
+    for (const auto& parcel : parcels) {
+      cdt.AddRing(parcel);
+    }
+    std::vector<p2t::Point*> ring{ &inner[0], &inner[1], &inner[2] };
+    if (!inner_ccw) {
+      std::reverse(ring.begin(), ring.end());
+    }
+    cdt.AddRing(ring);
+    cdt.AddPoint(&lone);
+    cdt.SetFillRule(rule);
+    cdt.Triangulate();
+    const auto triangles = cdt.GetTriangles();
+    const auto labels = cdt.GetTriangleLabels();
+    BOOST_REQUIRE_EQUAL(labels.size(), triangles.size());
+    Result result;
+    result.areas.resize(parcels.size() + 1);
+    for (size_t i = 0; i < triangles.size(); i++) {
+      const p2t::Point& a = *triangles[i]->GetPoint(0);
+      const p2t::Point& b = *triangles[i]->GetPoint(1);
+      const p2t::Point& c = *triangles[i]->GetPoint(2);
+      BOOST_REQUIRE_LT(labels[i], result.areas.size());
+      result.areas[labels[i]] += ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+      if (labels[i] < parcels.size()) {
+        // The centroid lies in the parcel
+        const double x = (a.x + b.x + c.x) / 30;
+        const double y = (a.y + b.y + c.y) / 30;
+        BOOST_CHECK_EQUAL(labels[i], static_cast<size_t>(y) * 3 + static_cast<size_t>(x));
+      }
+      for (bool constrained : triangles[i]->constrained_edge) {
+        result.constrained += constrained;
+      }
+    }
+    return result;
+  };
+  const double inner_area = 6 * 6 / 2;
+
+  // The triangle is a hole with either orientation for even-odd
+  Result even_odd = triangulate(p2t::FillRule::EvenOdd, true);
+  BOOST_CHECK_CLOSE(even_odd.areas[0], 100 - inner_area, kTolerance);
+  BOOST_CHECK_EQUAL(even_odd.areas[6], 0);
+  for (size_t i = 1; i < 6; i++) {
+    BOOST_CHECK_CLOSE(even_odd.areas[i], 100, kTolerance);
+  }
+  // Borders between parcels are seen from both sides
+  BOOST_CHECK_EQUAL(even_odd.constrained, 2 * 7 + 10 + 3);
+  BOOST_CHECK(triangulate(p2t::FillRule::EvenOdd, false).areas == even_odd.areas);
+
+  // Winding the same way as the parcel fills it for nonzero
+  Result nonzero = triangulate(p2t::FillRule::NonZero, true);
+  BOOST_CHECK_CLOSE(nonzero.areas[0], 100 - inner_area, kTolerance);
+  BOOST_CHECK_CLOSE(nonzero.areas[6], inner_area, kTolerance);
+  nonzero = triangulate(p2t::FillRule::NonZero, false);
+  BOOST_CHECK_EQUAL(nonzero.areas[6], 0);
+
+  p2t::CDT polygon({ &grid[0], &grid[1], &grid[5] });
+  BOOST_CHECK_THROW(polygon.AddRing(parcels[1]), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(MultiPolygonTest)
+{
+  // Islands shaped like a U, whose gap is closed off by the advancing front, and squares with a
+  // triangular hole
+  const std::vector<double> cup{ 0, 0, 3, 0, 3, 3, 2, 3, 2, 1, 1, 1, 1, 3, 0, 3 };
+  const std::vector<double> square{ 0, 0, 3, 0, 3, 3, 0, 3 };
+  const std::vector<double> hole{ 1, 1, 2, 2, 2, 1 };
+  std::vector<std::unique_ptr<p2t::Point>> points;
+  const auto make = [&points](const std::vector<double>& coordinates, double dx, double dy) {
+    std::vector<p2t::Point*> polyline;
+    for (size_t i = 0; i < coordinates.size(); i += 2) {
+      points.emplace_back(new p2t::Point(coordinates[i] + dx, coordinates[i + 1] + dy));
+      polyline.push_back(points.back().get());
+    }
+    return polyline;
+  };
+  const auto area = [](const std::vector<p2t::Triangle*>& triangles) {
+    double sum = 0;
+    for (p2t::Triangle* t : triangles) {
+      const p2t::Point& a = *t->GetPoint(0);
+      const p2t::Point& b = *t->GetPoint(1);
+      const p2t::Point& c = *t->GetPoint(2);
+      sum += ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+    }
+    return sum;
+  };
+
+  p2t::CDT cdt;
+  std::vector<std::vector<p2t::Point*>> holes;
+  double expected = 0;
+  for (int y = 0; y < 3; y++) {
+    for (int x = 0; x < 3; x++) {
+      if ((x + y) % 2 == 0) {
+        cdt.AddPolyline(make(cup, 4 * x, 4 * y));
+        expected += 7;
+      } else {
+        cdt.AddPolyline(make(square, 4 * x, 4 * y));
+        holes.push_back(make(hole, 4 * x, 4 * y));
+        expected += 9 - 0.5;
+      }
+    }
+  }
+  for (const auto& h : holes) {
+    cdt.AddHole(h);
+  }
+  cdt.Triangulate();
+  const auto triangles = cdt.GetTriangles();
+  BOOST_CHECK_CLOSE(area(triangles), expected, kTolerance);
+  // 5 cups with 6 triangles each, 4 squares with 7 each
+  BOOST_CHECK_EQUAL(triangles.size(), 5 * 6 + 4 * 7);
+  for (p2t::Triangle* t : triangles) {
+    // Nothing between the islands
+    const double x = (t->GetPoint(0)->x + t->GetPoint(1)->x + t->GetPoint(2)->x) / 3;
+    const double y = (t->GetPoint(0)->y + t->GetPoint(1)->y + t->GetPoint(2)->y) / 3;
+    BOOST_CHECK_LT(std::fmod(x, 4), 3);
+    BOOST_CHECK_LT(std::fmod(y, 4), 3);
+  }
+
+  // An island in the hole of another one is swept with it, islands far away on their own. The
+  // visitor still gets the points in input order.
+  const std::vector<double> frame{ 0, 0, 9, 0, 9, 9, 0, 9 };
+  const std::vector<double> window{ 2, 2, 7, 2, 7, 7, 2, 7 };
+  std::vector<p2t::Point*> input;
+  p2t::CDT nested;
+  for (const auto& polyline : { make(square, 20, 0), make(frame, 0, 0), make(square, 3, 3) }) {
+    nested.AddPolyline(polyline);
+    input.insert(input.end(), polyline.begin(), polyline.end());
+  }
+  const std::vector<p2t::Point*> inner = make(window, 0, 0);
+  nested.AddHole(inner);
+  input.insert(input.end(), inner.begin(), inner.end());
+  points.emplace_back(new p2t::Point(21, 1));
+  nested.AddPoint(points.back().get());
+  input.push_back(points.back().get());
+  struct Collector : p2t::TriangleVisitor {
+    std::vector<size_t> indices;
+    void Visit(const size_t triangle[3], const bool[3]) override
+    {
+      indices.insert(indices.end(), triangle, triangle + 3);
+    }
+  } collector;
+  nested.Triangulate(collector);
+  double visited = 0;
+  for (size_t i = 0; i < collector.indices.size(); i += 3) {
+    const p2t::Point& a = *input[collector.indices[i]];
+    const p2t::Point& b = *input[collector.indices[i + 1]];
+    const p2t::Point& c = *input[collector.indices[i + 2]];
+    visited += ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+  }
+  BOOST_CHECK_CLOSE(visited, 9 + 81 - 25 + 9, kTolerance);
+  // The Steiner point splits the square far away into 4 triangles
+  BOOST_CHECK_EQUAL(collector.indices.size(), 3 * (4 + 8 + 2));
+
+  // A single polyline added later is the same as one passed to the constructor
+  std::vector<p2t::Point*> single = make(cup, 0, 0);
+  p2t::CDT later;
+  later.AddPolyline(single);
+  BOOST_CHECK_THROW(later.AddRing(single), std::runtime_error);
+  later.Triangulate();
+  BOOST_CHECK_CLOSE(area(later.GetTriangles()), 7, kTolerance);
+}
+
+BOOST_AUTO_TEST_CASE(SplitIntersectionsTest)
+{
+  const auto area = [](const std::vector<p2t::Triangle*>& triangles) {
+    double sum = 0;
+    for (p2t::Triangle* t : triangles) {
+      const p2t::Point& a = *t->GetPoint(0);
+      const p2t::Point& b = *t->GetPoint(1);
+      const p2t::Point& c = *t->GetPoint(2);
+      sum += ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+    }
+    return sum;
+  };
+
+  // A bow tie crossing itself in the middle
+  std::vector<p2t::Point> bow_tie{ { 0, 0 }, { 2, 2 }, { 2, 0 }, { 0, 2 } };
+  std::vector<p2t::Point*> polyline{ &bow_tie[0], &bow_tie[1], &bow_tie[2], &bow_tie[3] };
+  struct Collector : p2t::TriangleVisitor {
+    std::vector<size_t> indices;
+    void Visit(const size_t triangle[3], const bool[3]) override
+    {
+      indices.insert(indices.end(), triangle, triangle + 3);
+    }
+  } collector;
+  {
+    p2t::CDT cdt(polyline);
+    cdt.SetSplitIntersections(true);
+    cdt.Triangulate(collector);
+    const auto intersections = cdt.GetIntersections();
+    BOOST_REQUIRE_EQUAL(intersections.size(), 1);
+    BOOST_CHECK_EQUAL(*intersections[0], p2t::Point(1, 1));
+  }
+  BOOST_CHECK_EQUAL(collector.indices.size(), 6);
+  BOOST_CHECK_EQUAL(std::count(collector.indices.begin(), collector.indices.end(), 4), 2);
+
+  // A hole touching the polyline and two holes crossing each other, their overlap is inside
+  std::vector<p2t::Point> points{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 },
+                                  { 0, 7 },  { 2, 9 },  { 0, 9 }, { 1, 1 },
+                                  { 5, 1 },  { 5, 5 },  { 1, 5 }, { 3, 3 },
+                                  { 7, 3 },  { 7, 7 },  { 3, 7 } };
+  p2t::CDT cdt({ &points[0], &points[1], &points[2], &points[3] });
+  cdt.AddHole({ &points[4], &points[5], &points[6] });
+  cdt.AddHole({ &points[7], &points[8], &points[9], &points[10] });
+  cdt.AddHole({ &points[11], &points[12], &points[13], &points[14] });
+  cdt.SetSplitIntersections(true);
+  cdt.Triangulate();
+  BOOST_CHECK_EQUAL(cdt.GetIntersections().size(), 2);
+  BOOST_CHECK_CLOSE(area(cdt.GetTriangles()), 100 - 2 - 16 - 16 + 2 * 4, kTolerance);
+
+  // Two holes sharing a piece of an edge, which is outside on both sides
+  std::vector<p2t::Point> adjacent{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 2, 2 }, { 5, 2 },
+                                    { 5, 6 }, { 2, 6 },  { 5, 3 },   { 8, 3 },  { 8, 5 }, { 5, 5 } };
+  p2t::CDT shared({ &adjacent[0], &adjacent[1], &adjacent[2], &adjacent[3] });
+  shared.AddHole({ &adjacent[4], &adjacent[5], &adjacent[6], &adjacent[7] });
+  shared.AddHole({ &adjacent[8], &adjacent[9], &adjacent[10], &adjacent[11] });
+  shared.SetSplitIntersections(true);
+  shared.Triangulate();
+  BOOST_CHECK_CLOSE(area(shared.GetTriangles()), 100 - 12 - 6, kTolerance);
+
+  // Rounded to integers the second crossing on the edge from (91, 21) to (30, 26) lies beside
+  // it, the pieces have to follow the edge and not the order of cmp
+  std::vector<p2t::Point> pentagon{ { 8, 1 }, { 92, 68 }, { 91, 21 }, { 30, 26 }, { 59, 49 } };
+  p2t::CDT crossed({ &pentagon[0], &pentagon[1], &pentagon[2], &pentagon[3], &pentagon[4] });
+  crossed.SetSplitIntersections(true);
+  crossed.Triangulate();
+  BOOST_CHECK_EQUAL(crossed.GetIntersections().size(), 2);
+
+  // Three edges of a hole through one point, and a second hole on a piece of one of them
+  std::vector<p2t::Point> spokes{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 2, 2 },
+                                  { 8, 8 }, { 8, 2 },  { 2, 8 },   { 5, 9 },  { 5, 1 },
+                                  { 5, 2 }, { 5, 4 },  { 6, 3 } };
+  p2t::CDT through({ &spokes[0], &spokes[1], &spokes[2], &spokes[3] });
+  through.AddHole({ &spokes[4], &spokes[5], &spokes[6], &spokes[7], &spokes[8], &spokes[9] });
+  through.AddHole({ &spokes[10], &spokes[11], &spokes[12] });
+  through.SetSplitIntersections(true);
+  through.Triangulate();
+  BOOST_REQUIRE_EQUAL(through.GetIntersections().size(), 1);
+  BOOST_CHECK_EQUAL(*through.GetIntersections()[0], p2t::Point(5, 5));
+  BOOST_CHECK_CLOSE(area(through.GetTriangles()), 100 - 9 - 6 - 6 - 1, kTolerance);
+}
+
+BOOST_AUTO_TEST_CASE(ValidateInputTest)
+{
+  using Type = p2t::InputError::Type;
+  std::vector<p2t::Point> points{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 2, 2 },
+                                  { 4, 2 }, { 4, 4 },  { 2, 4 },   { 0, 5 }, { 1, 6 },
+                                  { 1, 4 }, { 2, 4 },  { 5, 5 } };
+  const std::vector<p2t::Point*> outer{ &points[0], &points[1], &points[2], &points[3] };
+  const std::vector<p2t::Point*> square{ &points[4], &points[5], &points[6], &points[7] };
+  BOOST_CHECK(p2t::ValidateInput({ outer, square }, { &points[12] }).empty());
+
+  // A zero-length edge in the hole
+  auto errors = p2t::ValidateInput({ outer, { &points[4], &points[5], &points[6], &points[7],
+                                              &points[11] } });
+  BOOST_REQUIRE_EQUAL(errors.size(), 1);
+  BOOST_CHECK(errors[0].type == Type::RepeatPoint);
+  BOOST_CHECK_EQUAL(errors[0].first.polyline, 1);
+  BOOST_CHECK_EQUAL(errors[0].first.index, 3);
+  BOOST_CHECK_EQUAL(errors[0].second.index, 4);
+
+  // A hole touching the left edge of the outer polyline
+  errors = p2t::ValidateInput({ outer, square, { &points[8], &points[9], &points[10] } });
+  BOOST_REQUIRE_EQUAL(errors.size(), 1);
+  BOOST_CHECK(errors[0].type == Type::PointOnEdge);
+  BOOST_CHECK_EQUAL(errors[0].first.polyline, 2);
+  BOOST_CHECK_EQUAL(errors[0].first.index, 0);
+  BOOST_CHECK_EQUAL(errors[0].second.polyline, 0);
+  BOOST_CHECK_EQUAL(errors[0].second.index, 3);
+
+  // A bow tie
+  errors = p2t::ValidateInput({ { &points[4], &points[6], &points[5], &points[7] } });
+  BOOST_REQUIRE_EQUAL(errors.size(), 1);
+  BOOST_CHECK(errors[0].type == Type::CrossingEdges);
+  BOOST_CHECK_EQUAL(errors[0].first.index + errors[0].second.index, 2);
+
+  // A Steiner point on an edge of the hole
+  p2t::Point on_edge(3, 2);
+  errors = p2t::ValidateInput({ outer, square }, { &points[12], &on_edge });
+  BOOST_REQUIRE_EQUAL(errors.size(), 1);
+  BOOST_CHECK(errors[0].type == Type::PointOnEdge);
+  BOOST_CHECK_EQUAL(errors[0].first.polyline, 2);
+  BOOST_CHECK_EQUAL(errors[0].first.index, 1);
+  BOOST_CHECK_EQUAL(errors[0].second.polyline, 1);
+  BOOST_CHECK_EQUAL(errors[0].second.index, 0);
+}
+
+BOOST_AUTO_TEST_CASE(WeldPointsTest)
+{
+  // A polyline with a vertex repeated within the tolerance, Steiner points on top of a vertex
+  // and of each other
+  std::vector<p2t::Point> points{ { 0, 0 },      { 100000, 0 }, { 100000, 100000 },
+                                  { 100000, 100001 }, { 0, 100000 }, { 0, 0 },
+                                  { 50000, 50000 }, { 50001, 50000 } };
+  std::vector<p2t::Point*> polyline{ &points[0], &points[1], &points[2], &points[3], &points[4] };
+  struct Collector : p2t::TriangleVisitor {
+    std::vector<size_t> indices;
+    void Visit(const size_t triangle[3], const bool[3]) override
+    {
+      indices.insert(indices.end(), triangle, triangle + 3);
+    }
+  } collector;
+  {
+    p2t::CDT cdt(polyline);
+    for (size_t i = 5; i < points.size(); i++) {
+      cdt.AddPoint(&points[i]);
+    }
+    cdt.SetWeldTolerance(10);
+    cdt.Triangulate(collector);
+    const auto welds = cdt.GetWelds();
+    BOOST_REQUIRE_EQUAL(welds.size(), 3);
+    BOOST_CHECK_EQUAL(welds[0].first, &points[3]);
+    BOOST_CHECK_EQUAL(welds[0].second, &points[2]);
+    BOOST_CHECK_EQUAL(welds[1].first, &points[5]);
+    BOOST_CHECK_EQUAL(welds[1].second, &points[0]);
+    BOOST_CHECK_EQUAL(welds[2].first, &points[7]);
+    BOOST_CHECK_EQUAL(welds[2].second, &points[6]);
+  }
+  // The square around its center point, with the indices of the points added first
+  BOOST_CHECK_EQUAL(collector.indices.size(), 4 * 3);
+  for (size_t index : { 3, 5, 7 }) {
+    BOOST_CHECK_EQUAL(std::count(collector.indices.begin(), collector.indices.end(), index), 0);
+  }
+  BOOST_CHECK_EQUAL(std::count(collector.indices.begin(), collector.indices.end(), 6), 4);
+
+  // Exact welding leaves the near repeat alone
+  for (p2t::Point& point : points) {
+    point.edge_list.clear();
+  }
+  p2t::CDT exact(polyline);
+  exact.AddPoint(&points[5]);
+  exact.AddPoint(&points[6]);
+  exact.SetWeldTolerance(0);
+  exact.Triangulate();
+  BOOST_REQUIRE_EQUAL(exact.GetWelds().size(), 1);
+  BOOST_CHECK_EQUAL(exact.GetWelds()[0].first, &points[5]);
+}
+
+BOOST_AUTO_TEST_CASE(ScalarTest)
+{
+  // The products round to the same float, the predicates compute in at least double precision
+  const p2t::Scalar k = 10001;
+  BOOST_CHECK_EQUAL(p2t::Orient2d(p2t::Point(k + 1, k), p2t::Point(k, k - 1), p2t::Point(0, 0)),
+                    p2t::CW);
+
+  std::vector<p2t::Point> points;
+  for (int i = 0; i < 32; i++) {
+    const double angle = 2 * M_PI * i / 32;
+    const double radius = i % 2 ? k / 2 : k;
+    points.emplace_back(static_cast<p2t::Scalar>(std::round(k * std::cos(angle))),
+                        static_cast<p2t::Scalar>(std::round(radius * std::sin(angle))));
+  }
+  std::vector<p2t::Point*> polyline;
+  for (p2t::Point& point : points) {
+    polyline.push_back(&point);
+  }
+  p2t::CDT cdt(polyline);
+  cdt.Triangulate();
+  const std::vector<p2t::Triangle*> triangles = cdt.GetTriangles();
+  BOOST_CHECK_EQUAL(triangles.size(), points.size() - 2);
+  for (p2t::Triangle* t : triangles) {
+    BOOST_CHECK_EQUAL(p2t::Orient2d(*t->GetPoint(0), *t->GetPoint(1), *t->GetPoint(2)), p2t::CCW);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PerturbationTest)
+{
+  // Exactly one diagonal of a square is legal, no matter in which order the corners are passed
+  p2t::Point a(0, 0), b(1, 0), c(1, 1), d(0, 1);
+  const bool ac = !p2t::InCircumcircle(a, b, c, d);
+  BOOST_CHECK_EQUAL(ac, !p2t::InCircumcircle(c, d, a, b));
+  BOOST_CHECK_EQUAL(ac, p2t::InCircumcircle(b, c, d, a));
+  BOOST_CHECK_EQUAL(ac, p2t::InCircumcircle(d, a, b, c));
+
+  // Steiner points exactly on the edges of the polygon
+  std::vector<p2t::Point> square = { { 0, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 } };
+  std::vector<p2t::Point*> polyline;
+  for (p2t::Point& point : square) {
+    polyline.push_back(&point);
+  }
+  p2t::Point right(4, 2), bottom(2, 0), inner(2, 2);
+  p2t::CDT on_edges(polyline);
+  on_edges.AddPoint(&right);
+  on_edges.AddPoint(&bottom);
+  on_edges.AddPoint(&inner);
+  BOOST_REQUIRE_NO_THROW(on_edges.Triangulate());
+  double area = 0;
+  for (p2t::Triangle* t : on_edges.GetTriangles()) {
+    const double cross = p2t::Cross(*t->GetPoint(1) - *t->GetPoint(0),
+                                    *t->GetPoint(2) - *t->GetPoint(0));
+    BOOST_CHECK_GT(cross, 0);
+    area += cross / 2;
+  }
+  BOOST_CHECK_EQUAL(area, 16);
+
+  // Flipping towards the upper end of the slanted edge reaches the Steiner point on it, which
+  // splits the edge there
+  std::vector<p2t::Point> slanted = { { 0, 0 }, { 8, 2 }, { 8, 8 }, { 0, 8 } };
+  std::vector<p2t::Point*> slanted_polyline;
+  for (p2t::Point& point : slanted) {
+    slanted_polyline.push_back(&point);
+  }
+  p2t::Point on_slanted(4, 1), beside(6, 2);
+  p2t::CDT split(slanted_polyline);
+  split.AddPoint(&beside);
+  split.AddPoint(&on_slanted);
+  BOOST_REQUIRE_NO_THROW(split.Triangulate());
+  area = 0;
+  size_t constrained = 0;
+  for (p2t::Triangle* t : split.GetTriangles()) {
+    area += p2t::Cross(*t->GetPoint(1) - *t->GetPoint(0), *t->GetPoint(2) - *t->GetPoint(0)) / 2;
+    for (int i = 0; i < 3; i++) {
+      constrained += t->constrained_edge[i];
+    }
+  }
+  BOOST_CHECK_EQUAL(split.GetTriangles().size(), 5);
+  BOOST_CHECK_EQUAL(area, 64 - 8);
+  // Both pieces of the slanted edge are part of the border
+  BOOST_CHECK_EQUAL(constrained, 5);
+
+  // A grid has four cocircular points everywhere, the result doesn't depend on the order anymore
+  using Triangles = std::set<std::array<const p2t::Point*, 3>>;
+  const auto get_triangles = [](p2t::CDT& cdt) {
+    Triangles result;
+    for (p2t::Triangle* t : cdt.GetTriangles()) {
+      std::array<const p2t::Point*, 3> points = { t->GetPoint(0), t->GetPoint(1), t->GetPoint(2) };
+      std::sort(points.begin(), points.end());
+      result.insert(points);
+    }
+    return result;
+  };
+  const int m = 11;
+  std::vector<p2t::Point> grid;
+  for (int x = 1; x < m; x++) {
+    for (int y = 1; y < m; y++) {
+      grid.emplace_back(x, y);
+    }
+  }
+  for (p2t::Point& point : square) {
+    point.x *= m / 4.0;
+    point.y *= m / 4.0;
+  }
+  std::vector<Triangles> results;
+  for (bool reverse : { false, true }) {
+    for (p2t::Point& point : square) {
+      point.edge_list.clear();
+    }
+    p2t::CDT cdt(polyline);
+    cdt.Triangulate();
+    for (size_t i = 0; i < grid.size(); i++) {
+      cdt.InsertPoint(&grid[reverse ? grid.size() - 1 - i : i]);
+    }
+    BOOST_CHECK(p2t::IsDelaunay(cdt.GetTriangles()));
+    results.push_back(get_triangles(cdt));
+  }
+  BOOST_CHECK_EQUAL(results[0].size(), 2 * grid.size() + 2);
+  BOOST_CHECK(results[0] == results[1]);
+}
+
+#ifdef P2T_INTEGER_COORDINATES
+BOOST_AUTO_TEST_CASE(IntegerCoordinatesTest)
+{
+  // Both products round to 2^56 - 2^29 in double precision, the exact difference is -1
+  const double k = (1 << 28) - 1;
+  BOOST_CHECK_EQUAL(p2t::Orient2d(p2t::Point(k + 1, k), p2t::Point(k, k - 1), p2t::Point(0, 0)),
+                    p2t::CW);
+
+  // A convex chain that is almost a straight line at the largest allowed coordinates
+  std::vector<p2t::Point> points;
+  const int n = 64;
+  for (int i = 0; i <= n; i++) {
+    const double x = -k + i * std::floor(2 * k / n);
+    points.emplace_back(x, std::floor(x / 2) + (i - n / 2) * (i - n / 2));
+  }
+  std::vector<p2t::Point*> polyline;
+  for (p2t::Point& point : points) {
+    polyline.push_back(&point);
+  }
+  p2t::CDT cdt(polyline);
+  cdt.SetMonotoneFastPath(false);
+  cdt.Triangulate();
+  const std::vector<p2t::Triangle*> triangles = cdt.GetTriangles();
+  BOOST_CHECK_EQUAL(triangles.size(), points.size() - 2);
+  for (p2t::Triangle* t : triangles) {
+    BOOST_CHECK_EQUAL(p2t::Orient2d(*t->GetPoint(0), *t->GetPoint(1), *t->GetPoint(2)), p2t::CCW);
+  }
+
+  p2t::Point half(0.5, 0);
+  p2t::Point a(0, 1), b(1, 0), c(1, 1);
+  std::vector<p2t::Point*> fractional = { &half, &b, &c, &a };
+  p2t::CDT rejected(fractional);
+  BOOST_CHECK_THROW(rejected.Triangulate(), std::runtime_error);
+}
+#endif